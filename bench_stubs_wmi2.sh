@@ -0,0 +1,73 @@
+#!/usr/bin/env bash
+set -euxo pipefail
+
+# Measures what the string stubs cost KLEE: builds the bitcode with the
+# fixed-trip-count stubs (STUBS=select) and with the byte loops
+# (STUBS=bytewise), explores each to completion (no exit on the assertion,
+# capped at MAX_TIME) and reports states, tests, instructions, solver
+# queries and solver time side by side in $OUT/report.md.
+
+: "${SEARCH:=bfs}"
+: "${MAX_TIME:=300s}"
+: "${OUT:=klee-stubs}"
+
+for stubs in select bytewise; do
+  STUBS=$stubs OUT_BC="wmi2_stubs_$stubs.bc" ./build_wmi2.sh
+done
+
+rm -rf "$OUT"
+mkdir -p "$OUT"
+
+{ set +x; } 2>/dev/null
+# KLEE's summary lines in <dir>/info, e.g. "KLEE: done: completed paths = 449".
+info_count() {
+  sed -n "s/^KLEE: done: $2 = \([0-9]*\)$/\1/p" "$1/info" | head -n 1
+}
+
+# One column of `klee-stats --print-all` for <dir>, by header name.
+stat_col() {
+  klee-stats --print-all --table-format=csv "$1" 2>/dev/null |
+    awk -F, -v col="$2" 'NR == 1 { for (i = 1; i <= NF; i++) if ($i == col) c = i; next }
+                         c { print $c; exit }'
+}
+
+rows=()
+for stubs in select bytewise; do
+  dir="$OUT/$stubs"
+  bc="wmi2_stubs_$stubs.bc"
+  echo "[INFO] running KLEE on $bc"
+  start=$(date +%s.%N)
+  klee --search="$SEARCH" --max-time="$MAX_TIME" --output-dir="$dir" "$bc" \
+       > "$OUT/$stubs.log" 2>&1 || true
+  end=$(date +%s.%N)
+  completed=$(info_count "$dir" "completed paths")
+  partial=$(info_count "$dir" "partially completed paths")
+  states=$(( ${completed:-0} + ${partial:-0} ))
+  tests=$(info_count "$dir" "generated tests")
+  instrs=$(info_count "$dir" "total instructions")
+  queries=$(stat_col "$dir" "Queries")
+  solver=$(awk -v t="$(stat_col "$dir" "Time(s)")" -v p="$(stat_col "$dir" "TSolver(%)")" \
+           'BEGIN { if (t != "" && p != "") printf "%.2f", t * p / 100; else print "-" }')
+  wall=$(awk -v a="$start" -v b="$end" 'BEGIN { printf "%.2f", b - a }')
+  rows+=("$stubs|$states|${tests:--}|${instrs:--}|${queries:--}|$solver|$wall")
+done
+
+ratio() {
+  awk -v a="$1" -v b="$2" 'BEGIN { if (a + 0 > 0 && b != "-") printf "%.1f%%", 100 * b / a; else print "-" }'
+}
+
+IFS='|' read -r _ sel_st sel_te sel_in sel_qu sel_so sel_wa <<< "${rows[0]}"
+IFS='|' read -r _ byte_st byte_te byte_in byte_qu byte_so byte_wa <<< "${rows[1]}"
+{
+  echo "# WMI-2 string stubs (search $SEARCH, max time $MAX_TIME)"
+  echo
+  echo "| stubs | states | tests | instructions | queries | solver (s) | wall (s) |"
+  echo "|---|---|---|---|---|---|---|"
+  for r in "${rows[@]}"; do echo "| ${r//|/ | } |"; done
+  echo "| select / bytewise | $(ratio "$byte_st" "$sel_st") | $(ratio "$byte_te" "$sel_te") | $(ratio "$byte_in" "$sel_in") | $(ratio "$byte_qu" "$sel_qu") | $(ratio "$byte_so" "$sel_so") | $(ratio "$byte_wa" "$sel_wa") |"
+  echo
+  echo "States are completed plus partially completed paths. Both runs explore to completion unless MAX_TIME cuts them off; check the logs for \"HaltTimer\" before comparing."
+} | tee "$OUT/report.md"
+set -x
+
+echo "[OK] Wrote $OUT/report.md"
@@ -0,0 +1,302 @@
+// blacksun.c - MetaLogin Avatar Manager
+// Black Sun member directory: minimal perfect hash over member usernames.
+//
+// A directory maps each username to one slot with two hashes: the first
+// picks a bucket, the bucket's seed picks the slot (hash-and-displace).
+// Lookups cost two hashes and one compare, whatever the directory size.
+//
+// The built-in members are a table generated at build time (see
+// blacksun_gen.c and globals.c). Larger directories are memory-mapped text
+// files, one "username access_code" pair per line; entries point straight
+// into the mapping. blacksun_load publishes a new directory atomically:
+// readers never block, and the writer waits for readers of the old
+// directory to drain before unmapping it.
+#define _GNU_SOURCE
+#include "metalogin.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BS_BUCKET_KEYS   3          // average keys per bucket
+#define BS_MAX_SEED      (1u << 24)
+
+// ============================================================================
+// HASHING
+// ============================================================================
+uint64_t blacksun_hash(const char *s, size_t len, uint32_t seed) {
+    uint64_t h = 0xcbf29ce484222325ull ^ ((uint64_t)seed * 0x9E3779B97F4A7C15ull);
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 0x100000001b3ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static const bs_member *bs_find(const bs_directory *d, const char *username, size_t len) {
+    if (!d->nmembers) return NULL;
+    uint32_t b = (uint32_t)(blacksun_hash(username, len, 0) % d->nbuckets);
+    uint32_t slot = (uint32_t)(blacksun_hash(username, len, d->seeds[b]) % d->nmembers);
+    const bs_member *m = &d->slots[slot];
+    if (m->username_len != len || memcmp(m->username, username, len) != 0)
+        return NULL;
+    return m;
+}
+
+// Same contract as verify_black_sun_member: 1 granted, -1 wrong access code,
+// 0 not a member.
+static int bs_verify_in(const bs_directory *d, const char *username, const char *access_code) {
+    if (!username) return 0;
+    const bs_member *m = bs_find(d, username, strnlen(username, MAX_LENGTH));
+    if (!m) return 0;
+    size_t len = access_code ? strnlen(access_code, MAX_LENGTH) : 0;
+    if (access_code && m->access_code_len == len && memcmp(m->access_code, access_code, len) == 0)
+        return 1;
+    return -1;
+}
+
+// ============================================================================
+// CONSTRUCTION
+// ============================================================================
+// Places members into slots. On success d->slots and d->seeds are owned by d.
+int blacksun_build(bs_directory *d, const bs_member *members, uint32_t n) {
+    d->nmembers = n;
+    d->nbuckets = n / BS_BUCKET_KEYS + 1;
+    uint32_t *seeds = calloc(d->nbuckets, sizeof(*seeds));
+    bs_member *slots = calloc(n ? n : 1, sizeof(*slots));
+    uint32_t *bucket_of = malloc((n ? n : 1) * sizeof(*bucket_of));
+    uint32_t *start = calloc(d->nbuckets + 1, sizeof(*start));
+    uint32_t *order = malloc((n ? n : 1) * sizeof(*order));
+    uint32_t *fill = malloc(d->nbuckets * sizeof(*fill));
+    uint32_t *by_size = malloc(d->nbuckets * sizeof(*by_size));
+    uint32_t *cand = malloc((n ? n : 1) * sizeof(*cand));
+    uint8_t *taken = calloc(n ? n : 1, 1);
+    int rc = -ENOMEM;
+    if (!seeds || !slots || !bucket_of || !start || !order || !fill || !by_size || !cand || !taken)
+        goto out;
+
+    // Group member indices by bucket (counting sort).
+    uint32_t max_size = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        bucket_of[i] = (uint32_t)(blacksun_hash(members[i].username, members[i].username_len, 0)
+                                  % d->nbuckets);
+        start[bucket_of[i] + 1]++;
+    }
+    for (uint32_t b = 0; b < d->nbuckets; b++) {
+        if (start[b + 1] > max_size) max_size = start[b + 1];
+        start[b + 1] += start[b];
+    }
+    memcpy(fill, start, d->nbuckets * sizeof(*fill));
+    for (uint32_t i = 0; i < n; i++)
+        order[fill[bucket_of[i]]++] = i;
+
+    // Place the largest buckets first.
+    uint32_t nb = 0;
+    for (uint32_t size = max_size; size > 0; size--) {
+        for (uint32_t b = 0; b < d->nbuckets; b++) {
+            if (start[b + 1] - start[b] == size) by_size[nb++] = b;
+        }
+    }
+
+    for (uint32_t k = 0; k < nb; k++) {
+        uint32_t b = by_size[k];
+        const uint32_t *keys = &order[start[b]];
+        uint32_t size = start[b + 1] - start[b];
+        for (uint32_t i = 0; i < size; i++) {
+            for (uint32_t j = 0; j < i; j++) {
+                const bs_member *x = &members[keys[i]], *y = &members[keys[j]];
+                if (x->username_len == y->username_len &&
+                    memcmp(x->username, y->username, x->username_len) == 0) {
+                    fprintf(stderr, "[BLACKSUN] Duplicate member '%.*s'\n",
+                            (int)x->username_len, x->username);
+                    rc = -EINVAL;
+                    goto out;
+                }
+            }
+        }
+        uint32_t seed;
+        for (seed = 1; seed < BS_MAX_SEED; seed++) {
+            uint32_t i;
+            for (i = 0; i < size; i++) {
+                const bs_member *m = &members[keys[i]];
+                cand[i] = (uint32_t)(blacksun_hash(m->username, m->username_len, seed) % n);
+                if (taken[cand[i]]) break;
+                taken[cand[i]] = 1;
+            }
+            if (i == size) break;
+            while (i-- > 0) taken[cand[i]] = 0;
+        }
+        if (seed == BS_MAX_SEED) {
+            rc = -EAGAIN;
+            goto out;
+        }
+        seeds[b] = seed;
+        for (uint32_t i = 0; i < size; i++)
+            slots[cand[i]] = members[keys[i]];
+    }
+
+    d->seeds = seeds;
+    d->slots = slots;
+    seeds = NULL;
+    slots = NULL;
+    rc = 0;
+out:
+    free(seeds);
+    free(slots);
+    free(bucket_of);
+    free(start);
+    free(order);
+    free(fill);
+    free(by_size);
+    free(cand);
+    free(taken);
+    return rc;
+}
+
+static void bs_directory_free(bs_directory *d) {
+    if (!d || d == &black_sun_builtin_directory) return;
+    free((void *)d->seeds);
+    free((void *)d->slots);
+    if (d->map) munmap(d->map, d->map_len);
+    free(d);
+}
+
+// Splits a mapped directory file into members that point into the mapping.
+static int bs_parse(const char *p, size_t len, bs_member **out, uint32_t *nout) {
+    size_t cap = 1024, n = 0;
+    bs_member *members = malloc(cap * sizeof(*members));
+    if (!members) return -ENOMEM;
+    const char *end = p + len;
+    while (p < end) {
+        const char *eol = memchr(p, '\n', (size_t)(end - p));
+        if (!eol) eol = end;
+        const char *q = p;
+        while (q < eol && (*q == ' ' || *q == '\t')) q++;
+        const char *name = q;
+        while (q < eol && *q != ' ' && *q != '\t' && *q != '\r') q++;
+        const char *name_end = q;
+        while (q < eol && (*q == ' ' || *q == '\t')) q++;
+        const char *code = q;
+        while (q < eol && *q != ' ' && *q != '\t' && *q != '\r') q++;
+        if (name < name_end && *name != '#') {
+            if (code == q) {
+                fprintf(stderr, "[BLACKSUN] Missing access code for '%.*s'\n",
+                        (int)(name_end - name), name);
+                free(members);
+                return -EINVAL;
+            }
+            if (n == cap) {
+                bs_member *grown = realloc(members, cap * 2 * sizeof(*members));
+                if (!grown) {
+                    free(members);
+                    return -ENOMEM;
+                }
+                members = grown;
+                cap *= 2;
+            }
+            members[n].username = name;
+            members[n].username_len = (uint32_t)(name_end - name);
+            members[n].access_code = code;
+            members[n].access_code_len = (uint32_t)(q - code);
+            n++;
+        }
+        p = eol + 1;
+    }
+    *out = members;
+    *nout = (uint32_t)n;
+    return 0;
+}
+
+// ============================================================================
+// PUBLICATION
+// ============================================================================
+// Readers register in the counter for the current epoch before loading the
+// directory pointer. After swapping the pointer the writer flips the epoch
+// and waits for the old epoch's counter to drain; any reader that registers
+// later is guaranteed to load the new pointer. A reader that registers in an
+// epoch the writer has already flipped past (it read the epoch, then stalled
+// through a whole reload) would count in a counter nobody drains before the
+// next reload frees what it loads, so it checks the epoch again once
+// registered and retries if it moved.
+static _Atomic(const bs_directory *) bs_current = &black_sun_builtin_directory;
+static atomic_uint bs_epoch;
+static atomic_uint bs_readers[2];
+static pthread_mutex_t bs_reload_lock = PTHREAD_MUTEX_INITIALIZER;
+
+int blacksun_verify(const char *username, const char *access_code) {
+    unsigned epoch, e;
+    for (;;) {
+        epoch = atomic_load(&bs_epoch);
+        e = epoch & 1;
+        atomic_fetch_add(&bs_readers[e], 1);
+        if (atomic_load(&bs_epoch) == epoch)
+            break;
+        atomic_fetch_sub(&bs_readers[e], 1);
+    }
+    int rc = bs_verify_in(atomic_load(&bs_current), username, access_code);
+    atomic_fetch_sub(&bs_readers[e], 1);
+    return rc;
+}
+
+static void bs_publish(const bs_directory *d) {
+    pthread_mutex_lock(&bs_reload_lock);
+    const bs_directory *old = atomic_exchange(&bs_current, d);
+    unsigned e = atomic_fetch_add(&bs_epoch, 1) & 1;
+    while (atomic_load(&bs_readers[e]) != 0)
+        sched_yield();
+    pthread_mutex_unlock(&bs_reload_lock);
+    bs_directory_free((bs_directory *)old);
+}
+
+int blacksun_load(const char *path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -errno;
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int rc = -errno;
+        close(fd);
+        return rc;
+    }
+    bs_directory *d = calloc(1, sizeof(*d));
+    if (!d) {
+        close(fd);
+        return -ENOMEM;
+    }
+    d->map_len = (size_t)st.st_size;
+    if (d->map_len) {
+        d->map = mmap(NULL, d->map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (d->map == MAP_FAILED) {
+            int rc = -errno;
+            close(fd);
+            free(d);
+            return rc;
+        }
+        madvise(d->map, d->map_len, MADV_WILLNEED);
+    }
+    close(fd);
+
+    bs_member *members = NULL;
+    uint32_t n = 0;
+    int rc = bs_parse(d->map, d->map_len, &members, &n);
+    if (rc == 0)
+        rc = blacksun_build(d, members, n);
+    free(members);
+    if (rc < 0) {
+        bs_directory_free(d);
+        return rc;
+    }
+    bs_publish(d);
+    return (int)n;
+}
+
+void blacksun_reset(void) {
+    bs_publish(&black_sun_builtin_directory);
+}
@@ -0,0 +1,50 @@
+// blacksun_gen.c - MetaLogin Avatar Manager
+// Emits the built-in Black Sun members as a perfect-hash table for globals.c.
+#include "metalogin.h"
+
+static void emit_string(const char *s, uint32_t len) {
+    putchar('"');
+    for (uint32_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c == '"' || c == '\\') printf("\\%c", c);
+        else if (c >= 0x20 && c <= 0x7E) putchar(c);
+        else printf("\\%03o", c);
+    }
+    putchar('"');
+}
+
+int main(void) {
+    bs_member members[NUM_BLACK_SUN_MEMBERS];
+    bs_directory d = {0};
+
+    for (uint32_t i = 0; i < NUM_BLACK_SUN_MEMBERS; i++) {
+        members[i].username = black_sun_member_usernames[i];
+        members[i].username_len = (uint32_t)strlen(black_sun_member_usernames[i]);
+        members[i].access_code = black_sun_member_access_codes[i];
+        members[i].access_code_len = (uint32_t)strlen(black_sun_member_access_codes[i]);
+    }
+    if (blacksun_build(&d, members, NUM_BLACK_SUN_MEMBERS) < 0) {
+        fprintf(stderr, "[ERROR] Could not build the built-in directory\n");
+        return 1;
+    }
+
+    printf("// Generated by blacksun_gen - do not edit.\n");
+    printf("static const uint32_t black_sun_builtin_seeds[] = {");
+    for (uint32_t b = 0; b < d.nbuckets; b++)
+        printf("%s%u", b ? ", " : " ", d.seeds[b]);
+    printf(" };\n\n");
+    printf("static const bs_member black_sun_builtin_slots[] = {\n");
+    for (uint32_t i = 0; i < d.nmembers; i++) {
+        printf("    { ");
+        emit_string(d.slots[i].username, d.slots[i].username_len);
+        printf(", %u, ", d.slots[i].username_len);
+        emit_string(d.slots[i].access_code, d.slots[i].access_code_len);
+        printf(", %u },\n", d.slots[i].access_code_len);
+    }
+    printf("};\n\n");
+    printf("const bs_directory black_sun_builtin_directory = {\n");
+    printf("    %u, %u, black_sun_builtin_seeds, black_sun_builtin_slots, NULL, 0\n",
+           d.nmembers, d.nbuckets);
+    printf("};\n");
+    return 0;
+}
@@ -0,0 +1,19 @@
+#!/usr/bin/env bash
+set -euxo pipefail
+
+# Native build of the core microbenchmarks (see metalogin_bench.c).
+
+: "${CC:=cc}"
+: "${CFLAGS:=}"
+
+test -f metalogin_bench.c
+test -f metalogin.c
+test -f metalogin.h
+test -f blacksun.c
+test -f metalogin_stats.c
+test -f metalogin_journal.c
+
+"$CC" -I. -O2 -g -pthread -DMETALOGIN_NO_MAIN $CFLAGS metalogin_bench.c metalogin.c blacksun.c metalogin_stats.c metalogin_journal.c globals.c -o metalogin_bench
+
+ls -la metalogin_bench
+echo "[OK] Built metalogin_bench; run ./metalogin_bench -o bench.json"
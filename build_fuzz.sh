@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+set -euxo pipefail
+
+# In-process fuzzer for the WMI-2 leak (see fuzz_wmi2.c). ENGINE=libfuzzer
+# links clang's libFuzzer for coverage-guided search; ENGINE=standalone
+# builds the harness's own random driver with any C compiler; auto picks
+# libfuzzer when clang is on PATH. No AddressSanitizer: the oracle reads
+# the freed avatar on purpose, and it needs glibc's heap, not ASan's.
+
+: "${ENGINE:=auto}"
+: "${CFLAGS:=}"
+
+test -f fuzz_wmi2.c
+test -f driver_wmi2_leak.c
+test -f metalogin.c
+test -f metalogin.h
+test -f blacksun.c
+test -f metalogin_stats.c
+test -f metalogin_journal.c
+
+if [ "$ENGINE" = auto ]; then
+  if command -v clang >/dev/null 2>&1; then ENGINE=libfuzzer; else ENGINE=standalone; fi
+fi
+
+case "$ENGINE" in
+  libfuzzer)  : "${CC:=clang}"; ENGINE_FLAGS="-fsanitize=fuzzer -DWMI2_LIBFUZZER" ;;
+  standalone) : "${CC:=cc}";    ENGINE_FLAGS="" ;;
+  *) echo "[ERROR] ENGINE must be auto, libfuzzer or standalone"; exit 1 ;;
+esac
+
+"$CC" -I. -O2 -g -pthread -DMETALOGIN_NO_MAIN -DMETALOGIN_SYSTEM_ALLOC -DWMI2_DRIVER_NO_MAIN \
+  $ENGINE_FLAGS $CFLAGS \
+  fuzz_wmi2.c driver_wmi2_leak.c metalogin.c blacksun.c metalogin_stats.c metalogin_journal.c globals.c \
+  -o fuzz_wmi2
+
+ls -la fuzz_wmi2
+echo "[OK] Built fuzz_wmi2 ($ENGINE)"
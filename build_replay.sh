@@ -0,0 +1,25 @@
+#!/usr/bin/env bash
+set -euxo pipefail
+
+# Native -O2 replay of KLEE test cases (see replay_wmi2.c). metalogin.c is
+# built with METALOGIN_SYSTEM_ALLOC, like the KLEE bitcode, so a stale avatar
+# stays a plain heap pointer; driver_wmi2_leak.c contributes its sequence
+# but not its main.
+
+: "${CC:=cc}"
+: "${CFLAGS:=}"
+
+test -f replay_wmi2.c
+test -f driver_wmi2_leak.c
+test -f metalogin.c
+test -f metalogin.h
+test -f blacksun.c
+test -f metalogin_stats.c
+test -f metalogin_journal.c
+
+"$CC" -I. -O2 -g -pthread -DMETALOGIN_NO_MAIN -DMETALOGIN_SYSTEM_ALLOC -DWMI2_DRIVER_NO_MAIN $CFLAGS \
+  replay_wmi2.c driver_wmi2_leak.c metalogin.c blacksun.c metalogin_stats.c metalogin_journal.c globals.c \
+  -o replay_wmi2
+
+ls -la replay_wmi2
+echo "[OK] Built replay_wmi2; run ./replay_wmi2 klee-out-0"
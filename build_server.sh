@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+set -euxo pipefail
+
+# Native build of the socket front end and its load generator.
+# CFLAGS=-DMETALOGIN_STATS builds the instrumented server and the
+# metalogin_stats_dump reader (see metalogin_stats.c). metalogin_journal_dump
+# decodes the audit journal (see metalogin_journal.c).
+
+: "${CC:=cc}"
+: "${CFLAGS:=}"
+
+test -f metalogin_server.c
+test -f metalogin_client.c
+test -f metalogin.c
+test -f metalogin.h
+test -f blacksun.c
+test -f metalogin_stats.c
+test -f metalogin_journal.c
+
+"$CC" -I. -O2 -g -pthread -DMETALOGIN_NO_MAIN $CFLAGS metalogin_server.c metalogin.c blacksun.c metalogin_stats.c metalogin_journal.c globals.c -o metalogin_server
+"$CC" -I. -O2 -g metalogin_client.c -o metalogin_client
+"$CC" -I. -O2 -g metalogin_journal_dump.c -o metalogin_journal_dump
+if [[ "$CFLAGS" == *METALOGIN_STATS* ]]; then
+    "$CC" -I. -O2 -g $CFLAGS metalogin_stats_dump.c metalogin_stats.c -o metalogin_stats_dump
+fi
+
+ls -la metalogin_server metalogin_client metalogin_journal_dump
+echo "[OK] Built metalogin_server, metalogin_client and metalogin_journal_dump"
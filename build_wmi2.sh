@@ -1,12 +1,57 @@
 #!/usr/bin/env bash
 set -euxo pipefail
 
+# Incremental build of the KLEE bitcode. Every translation unit's bitcode is
+# cached in $CACHE under the hash of its preprocessed source (so every header
+# it includes counts), its flags and the clang/llvm-link versions; a unit is
+# only recompiled when one of those changes. Links are cached the same way,
+# keyed on their inputs: the stubs, metalogin.c and globals.c are linked once
+# into a library bitcode that every driver variant reuses, so changing only
+# the driver costs one compile and one small link.
+#
+#   DRIVER=driver_wmi2_other.c OUT_BC=other.bc ./build_wmi2.sh
+#
+# PROFILE=opt is the analysis profile: units are compiled without optnone or
+# builtin recognition, and the linked module goes through OPT_PASSES. That
+# pipeline promotes allocas (mem2reg, SROA), inlines the libc stubs, and
+# internalizes everything but main (and the memcpy/memset stubs, which KLEE
+# lowers its memory intrinsics to) so globaldce drops UI-only code such as
+# show_menu. Library-call simplification stays off so calls into the stubs
+# are never rewritten to functions the stubs do not define. The build fails
+# if the optimized module has lost its free() calls or the driver's
+# klee_assert, which klee.h expands to a call to __assert_fail (the driver is
+# the only unit that asserts). compare_wmi2.sh measures both profiles under
+# KLEE.
+#
+# STUBS=bytewise builds the stubs with the plain byte-loop string functions
+# instead of the fixed-trip-count ones; bench_stubs_wmi2.sh compares the two.
+#
+# HEAP=tcache builds every unit with -DWMI2_TCACHE: the stubs then serve
+# metalogin.c's allocations from a glibc tcache model (see stubs_wmi2.c), so
+# freed chunks are reused deterministically, and the leak oracle is the only
+# check since KLEE no longer sees stale reads inside the model's arena.
+#
+# STDIN=symbolic makes every fgets in the stubs return a fresh symbolic line
+# of up to STDIN_LINE bytes (default 4) instead of the fixed "127", so
+# set_start_location explores both the port and the name branch.
+
 : "${KLEE_INC:=/usr/local/include}"
+: "${CACHE:=.bc-cache}"
+: "${DRIVER:=driver_wmi2_leak.c}"
+: "${OUT_BC:=wmi2_demo.bc}"
+: "${PROFILE:=O0}"
+: "${STUBS:=select}"
+: "${HEAP:=klee}"
+: "${STDIN:=fixed}"
+: "${STDIN_LINE:=4}"
+
+OPT_PASSES='internalize,function(mem2reg,sroa,early-cse,instcombine,simplifycfg),cgscc(inline),function(sroa,early-cse,instcombine,simplifycfg,adce),globaldce'
+OPT_ARGS=(-internalize-public-api-list=main,memcpy,memset -inline-threshold=1000 -disable-simplify-libcalls)
 
 echo "[INFO] pwd=$(pwd)"
 echo "[INFO] KLEE_INC=$KLEE_INC"
 
-test -f driver_wmi2_leak.c
+test -f "$DRIVER"
 test -f stubs_wmi2.c
 test -f metalogin.c
 test -f metalogin.h
@@ -19,18 +64,101 @@ else
   KLEE_ARGS=()
 fi
 
-clang "${KLEE_ARGS[@]}" -I. -O0 -g -emit-llvm -c driver_wmi2_leak.c -o driver_wmi2_leak.bc
-clang "${KLEE_ARGS[@]}" -I. -O0 -g -emit-llvm -c stubs_wmi2.c -o stubs_wmi2.bc
+mkdir -p "$CACHE"
+case "$PROFILE" in
+  O0)  CFLAGS_PROFILE=(-O0) ;;
+  opt) CFLAGS_PROFILE=(-O0 -Xclang -disable-O0-optnone -fno-builtin) ;;
+  *)   echo "[ERROR] PROFILE must be O0 or opt" >&2; exit 2 ;;
+esac
+case "$STUBS" in
+  select)   STUB_FLAGS=() ;;
+  bytewise) STUB_FLAGS=(-DWMI2_STUBS_BYTEWISE) ;;
+  *)        echo "[ERROR] STUBS must be select or bytewise" >&2; exit 2 ;;
+esac
+case "$HEAP" in
+  klee)   HEAP_FLAGS=() ;;
+  tcache) HEAP_FLAGS=(-DWMI2_TCACHE) ;;
+  *)      echo "[ERROR] HEAP must be klee or tcache" >&2; exit 2 ;;
+esac
+case "$STDIN" in
+  fixed)    STDIN_FLAGS=() ;;
+  symbolic) STDIN_FLAGS=(-DWMI2_SYMBOLIC_STDIN -DWMI2_STDIN_LINE="$STDIN_LINE") ;;
+  *)        echo "[ERROR] STDIN must be fixed or symbolic" >&2; exit 2 ;;
+esac
+
+TOOLS_ID=$({ clang --version; llvm-link --version; [ "$PROFILE" = O0 ] || opt --version; } |
+           sha256sum | cut -d' ' -f1)
+
+# compile SRC OUT FLAGS...: OUT is a copy of the cached bitcode for SRC.
+compile() {
+  local src=$1 out=$2 key
+  shift 2
+  key=$({ echo "$TOOLS_ID"; printf '%s\n' "$@"; clang "$@" -E "$src"; } | sha256sum | cut -d' ' -f1)
+  if [ -f "$CACHE/$key.bc" ]; then
+    echo "[CACHE] $src: up to date"
+  else
+    clang "$@" -emit-llvm -c "$src" -o "$CACHE/$key.bc.tmp"
+    mv "$CACHE/$key.bc.tmp" "$CACHE/$key.bc"
+  fi
+  cp -f "$CACHE/$key.bc" "$out"
+}
+
+# link OUT INPUTS...: OUT is a copy of the cached link of INPUTS, in order.
+link() {
+  local out=$1 key
+  shift
+  key=$({ echo "$TOOLS_ID"; sha256sum "$@" | cut -d' ' -f1; } | sha256sum | cut -d' ' -f1)
+  if [ -f "$CACHE/link-$key.bc" ]; then
+    echo "[CACHE] $out: up to date"
+  else
+    llvm-link "$@" -o "$CACHE/link-$key.bc.tmp"
+    mv "$CACHE/link-$key.bc.tmp" "$CACHE/link-$key.bc"
+  fi
+  cp -f "$CACHE/link-$key.bc" "$out"
+}
 
-clang "${KLEE_ARGS[@]}" -DKLEE_DRIVER_BUILD -I. -O0 -g -emit-llvm -c metalogin.c -o metalogin.bc
+# optimize OUT IN: OUT is a copy of the cached OPT_PASSES output for IN.
+optimize() {
+  local out=$1 in=$2 key
+  key=$({ echo "$TOOLS_ID"; echo "$OPT_PASSES ${OPT_ARGS[*]}"; sha256sum < "$in"; } |
+        sha256sum | cut -d' ' -f1)
+  if [ -f "$CACHE/opt-$key.bc" ]; then
+    echo "[CACHE] $out: up to date"
+  else
+    opt -passes="$OPT_PASSES" "${OPT_ARGS[@]}" "$in" -o "$CACHE/opt-$key.bc.tmp"
+    mv "$CACHE/opt-$key.bc.tmp" "$CACHE/opt-$key.bc"
+  fi
+  cp -f "$CACHE/opt-$key.bc" "$out"
+}
+
+CFLAGS_BC=("${KLEE_ARGS[@]}" -I. "${CFLAGS_PROFILE[@]}" "${HEAP_FLAGS[@]}" -g)
+
+driver_bc="$(basename "${DRIVER%.c}").bc"
+compile "$DRIVER" "$driver_bc" "${CFLAGS_BC[@]}"
+compile stubs_wmi2.c stubs_wmi2.bc "${CFLAGS_BC[@]}" "${STUB_FLAGS[@]}" "${STDIN_FLAGS[@]}"
+compile metalogin.c metalogin.bc "${CFLAGS_BC[@]}" -DKLEE_DRIVER_BUILD
 
 EXTRA_BC=()
 if [ -f globals.c ]; then
-  clang "${KLEE_ARGS[@]}" -DKLEE_DRIVER_BUILD -I. -O0 -g -emit-llvm -c globals.c -o globals.bc
+  compile globals.c globals.bc "${CFLAGS_BC[@]}" -DKLEE_DRIVER_BUILD
   EXTRA_BC+=(globals.bc)
 fi
 
-llvm-link driver_wmi2_leak.bc stubs_wmi2.bc metalogin.bc "${EXTRA_BC[@]}" -o wmi2_demo.bc
+link wmi2_lib.bc stubs_wmi2.bc metalogin.bc "${EXTRA_BC[@]}"
+if [ "$PROFILE" = O0 ]; then
+  link "$OUT_BC" "$driver_bc" wmi2_lib.bc
+else
+  link wmi2_linked.bc "$driver_bc" wmi2_lib.bc
+  optimize "$OUT_BC" wmi2_linked.bc
+  rm -f wmi2_linked.bc
+  # The heap traffic behind the bug must survive the pipeline.
+  llvm-dis "$OUT_BC" -o - > "$CACHE/check.ll"
+  grep -q 'call void @free(' "$CACHE/check.ll"
+  if [ "${#KLEE_ARGS[@]}" -gt 0 ]; then
+    grep -q 'call void @__assert_fail(' "$CACHE/check.ll"
+  fi
+  rm -f "$CACHE/check.ll"
+fi
 
 ls -la *.bc
-echo "[OK] Built wmi2_demo.bc"
+echo "[OK] Built $OUT_BC"
@@ -0,0 +1,78 @@
+#!/usr/bin/env bash
+set -euxo pipefail
+
+# Runs KLEE on the -O0 and the optimized (PROFILE=opt) bitcode with the same
+# search and budget, and reports the cost of each profile side by side:
+# instructions executed, states, tests generated and time to the first
+# assertion failure. The report goes to $OUT/report.md.
+#
+# Both modules must still call __assert_fail, which is what klee.h turns the
+# driver's klee_assert into; without it (for example a build that did not
+# find klee.h) no run can reach the assertion and the report is refused.
+
+: "${SEARCH:=bfs}"
+: "${MAX_TIME:=60s}"
+: "${OUT:=klee-cmp}"
+
+command -v klee >/dev/null
+
+for profile in O0 opt; do
+  PROFILE=$profile OUT_BC="wmi2_$profile.bc" ./build_wmi2.sh
+  if ! llvm-dis "wmi2_$profile.bc" -o - | grep -c 'call void @__assert_fail(' >/dev/null; then
+    echo "[ERROR] wmi2_$profile.bc has no __assert_fail call; was klee.h found?" >&2
+    exit 1
+  fi
+done
+
+rm -rf "$OUT"
+mkdir -p "$OUT"
+
+{ set +x; } 2>/dev/null
+# KLEE's summary lines in <dir>/info, e.g. "KLEE: done: total instructions = 7293834".
+info_count() {
+  sed -n "s/^KLEE: done: $2 = \([0-9]*\)$/\1/p" "$1/info" | head -n 1
+}
+
+rows=()
+for profile in O0 opt; do
+  dir="$OUT/$profile"
+  bc="wmi2_$profile.bc"
+  ir=$(llvm-dis "$bc" -o - | awk '/^define /{f=1; next} /^}/{f=0} f && /^  [^ ;]/' | wc -l)
+  echo "[INFO] running KLEE on $bc"
+  start=$(date +%s.%N)
+  klee --search="$SEARCH" --max-time="$MAX_TIME" --exit-on-error-type=Assert \
+       --output-dir="$dir" "$bc" > "$OUT/$profile.log" 2>&1 || true
+  end=$(date +%s.%N)
+  instrs=$(info_count "$dir" "total instructions")
+  completed=$(info_count "$dir" "completed paths")
+  partial=$(info_count "$dir" "partially completed paths")
+  tests=$(info_count "$dir" "generated tests")
+  states=$(( ${completed:-0} + ${partial:-0} ))
+  err=$(compgen -G "$dir/*.assert.err" | head -n 1) || true
+  tta="-"
+  if [ -n "$err" ]; then
+    tta=$(awk -v a="$start" -v b="$(date -r "$err" +%s.%N)" 'BEGIN { printf "%.2f", b - a }')
+  fi
+  wall=$(awk -v a="$start" -v b="$end" 'BEGIN { printf "%.2f", b - a }')
+  rows+=("$profile|$ir|${instrs:--}|$states|${tests:--}|$tta|$wall")
+done
+
+ratio() {
+  awk -v a="$1" -v b="$2" 'BEGIN { if (a + 0 > 0 && b != "-") printf "%.1f%%", 100 * b / a; else print "-" }'
+}
+
+IFS='|' read -r _ ir0 in0 st0 _ tta0 _ <<< "${rows[0]}"
+IFS='|' read -r _ ir1 in1 st1 _ tta1 _ <<< "${rows[1]}"
+{
+  echo "# WMI-2 bitcode profiles (search $SEARCH, max time $MAX_TIME)"
+  echo
+  echo "| profile | IR instructions | instructions executed | states | tests | time to assert (s) | wall (s) |"
+  echo "|---|---|---|---|---|---|---|"
+  for r in "${rows[@]}"; do echo "| ${r//|/ | } |"; done
+  echo "| opt / O0 | $(ratio "$ir0" "$ir1") | $(ratio "$in0" "$in1") | $(ratio "$st0" "$st1") | | $(ratio "$tta0" "$tta1") | |"
+  echo
+  echo "States are completed plus partially completed paths. A \"-\" time to assert means the run ended without an assertion failure."
+} | tee "$OUT/report.md"
+set -x
+
+echo "[OK] Wrote $OUT/report.md"
@@ -1,16 +1,33 @@
 /*
  * WMI-2 (Leak via Type Confusion) — KLEE driver
  *
- * Model: After set_avatar → clear_avatar, g_session.current_avatar is a stale
+ * Model: After set_avatar → clear_avatar, the session's current_avatar is a stale
  * pointer. We call set_start_location() which allocates; the allocator may
- * reuse the freed avatar chunk. We then read the "username" field (offset 16)
- * from the stale pointer. If that memory was overwritten with a heap pointer
- * (e.g. from a new allocation), we have an information leak: a pointer value
- * is observable as if it were user data.
+ * reuse the freed avatar chunk. We then read the inline "username" bytes
+ * (offset 24) from the stale pointer. If that memory was overwritten with a
+ * heap pointer (allocator metadata or a new object), we have an information
+ * leak: a pointer value is observable as if it were user data.
  *
  * Assertion: The 8-byte value at (current_avatar + offsetof(avatar, username))
- * must NOT be a valid heap address. If it is, we report a leak (assert fails).
+ * must NOT be the address of a chunk metalogin.c allocated, live or freed.
+ * The stubs' shadow heap records every such chunk with its allocation site
+ * (see shadow_lookup in metalogin.h), so the check does not depend on where
+ * the heap happens to start and names the chunk that leaked.
  *
+ * Sharding: "klee wmi2_demo.bc <shard> <nshards>" explores only usernames
+ * whose first byte is congruent to shard mod nshards, so run_wmi2.sh can
+ * split the input space into disjoint parts, one KLEE per core. The
+ * arguments are concrete; without them the whole space is explored.
+ *
+ * Allocator: built with HEAP=tcache (WMI2_TCACHE), the stubs allocate from
+ * a glibc tcache model, so freed chunks are reused in glibc's order on
+ * every path rather than whenever KLEE's allocator happens to. KLEE no
+ * longer flags the stale read inside the model's arena, so the leak check
+ * below is the verdict.
+ *
+ * Replay: wmi2_leak_sequence is the part KLEE explores; replay_wmi2.c links
+ * this file with -DWMI2_DRIVER_NO_MAIN and runs it natively on the inputs
+ * of each .ktest file.
  */
 #include <stdint.h>
 #include <stddef.h>
@@ -25,22 +42,56 @@
 
 #include "metalogin.h"
 
-#define HEAP_START  0x77fe00000000ULL
-#define HEAP_END    0x78000000000ULL
+/* WMI-2 path: create avatar, free it (stale ref), then allocate to encourage
+ * reuse. Returns the avatar the session still points at, or NULL. */
+avatar *wmi2_leak_sequence(session_h sess, char *username, char *access_code) {
+  set_avatar(sess, username, access_code);
+  clear_avatar(sess);
+  set_start_location(sess);   /* uses fgets stub that returns "127" → allocates start_loc */
+  return avatar_get(session_get(sess)->current_avatar);
+}
 
-static int is_in_heap_range(uintptr_t value) {
-  return (value >= HEAP_START && value <= HEAP_END);
+/* The leak oracle: stores the 8 bytes at av->username in *leaked and returns
+ * whether is_heap takes them for a heap address. KLEE asks the shadow heap;
+ * replay_wmi2.c and fuzz_wmi2.c ask for the process's [heap] range. */
+int wmi2_leaks(const avatar *av, int (*is_heap)(uintptr_t), uintptr_t *leaked) {
+  uintptr_t v = *(const uintptr_t *)((const char *)av + offsetof(avatar, username));
+  if (leaked) *leaked = v;
+  return is_heap(v);
+}
+
+#ifndef WMI2_DRIVER_NO_MAIN
+/* A concrete value is a leak when it is the address of a known chunk. A
+ * symbolic one is still the caller's own input, whatever it may equal. */
+static int is_heap_address(uintptr_t value) {
+#ifdef __KLEE__
+  if (klee_is_symbolic(value)) return 0;
+#endif
+  return shadow_lookup(value, NULL, NULL, NULL, NULL) >= 0;
 }
 
-void init_system(void);
-void set_avatar(char *username, char *access_code);
-void clear_avatar(void);
-void set_start_location(void);
+/* Decimal argument parser; the stubs leave out the libc conversions. */
+static int parse_shard_arg(const char *s) {
+  int v = 0;
+  if (!s || !*s) return -1;
+  for (; *s; s++) {
+    if (*s < '0' || *s > '9' || v > 255) return -1;
+    v = v * 10 + (*s - '0');
+  }
+  return v;
+}
 
-extern session g_session;
+int main(int argc, char **argv) {
+  int shard = 0, nshards = 1;
+  if (argc == 3) {
+    shard = parse_shard_arg(argv[1]);
+    nshards = parse_shard_arg(argv[2]);
+    if (nshards < 1 || nshards > 255 || shard < 0 || shard >= nshards)
+      return 2;
+  }
 
-int main(void) {
   init_system();
+  session_h sess = session_open();
 
   char username[MAX_LENGTH];
   char access_code[MAX_LENGTH];
@@ -51,22 +102,18 @@ int main(void) {
   username[sizeof(username) - 1] = 0;
   access_code[sizeof(access_code) - 1] = 0;
   klee_assume((unsigned char)username[0] != 0);
+  if (nshards > 1)
+    klee_assume((unsigned char)username[0] % nshards == shard);
 #endif
 
-  /* WMI-2 path: create avatar, free it (stale ref), then allocate to encourage reuse */
-  set_avatar(username, access_code);
-  clear_avatar();
-  set_start_location();   /* uses fgets stub that returns "127" → allocates start_loc + location_name */
-
   /* Read the "username" field from the stale avatar. If the chunk was reused,
    * this may now hold a heap pointer (type confusion / leak). */
-  if (g_session.current_avatar) {
-    uintptr_t leaked = *(uintptr_t *)((char *)g_session.current_avatar + offsetof(avatar, username));
-#ifdef __KLEE__
+  avatar *av = wmi2_leak_sequence(sess, username, access_code);
+  if (av) {
     /* Fail when we observe a heap pointer in "user" data → information leak */
-    klee_assert(!is_in_heap_range(leaked));
-#endif
+    klee_assert(!wmi2_leaks(av, is_heap_address, NULL));
   }
 
   return 0;
 }
+#endif
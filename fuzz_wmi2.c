@@ -0,0 +1,324 @@
+// fuzz_wmi2.c - MetaLogin Avatar Manager
+// In-process fuzzing of the WMI-2 leak:
+//
+//   ./build_fuzz.sh
+//   ./fuzz_wmi2 fuzz_corpus/            # libFuzzer (clang), coverage guided
+//   ./fuzz_wmi2 -n 1000000 [-s seed]    # standalone, random inputs
+//   ./fuzz_wmi2 fuzz_corpus/*.bin       # standalone, rerun saved inputs
+//
+// An input is a sequence of up to FUZZ_MAX_OPS menu operations, each an
+// opcode byte followed by its operands. Every run opens a session, applies
+// the operations and closes it again, so the process is never restarted.
+// metalogin.c is built with METALOGIN_SYSTEM_ALLOC, as for KLEE and
+// replay_wmi2, so the avatar is a plain glibc heap chunk.
+//
+// The oracle is the driver's: while the session points at a freed avatar,
+// wmi2_leaks (driver_wmi2_leak.c) is checked after every operation, and a
+// heap address in the username bytes aborts the run, unless the input
+// itself supplied those bytes. Every operation stays allowed with a stale
+// avatar; the library no longer frees or writes through an avatar
+// clear_avatar released, and session_close cleans up. Logins, inventory
+// slabs and start locations then reshape the heap around the freed chunk
+// until glibc reuses it. fuzz_corpus/wmi2_leak.bin is a leaking input (see
+// README section 13).
+#include "metalogin.h"
+
+#include <time.h>
+
+#define FUZZ_MAX_OPS 64
+
+enum {
+    OP_SET_AVATAR,
+    OP_CLEAR_AVATAR,
+    OP_SET_START_LOC,
+    OP_CLEAR_START_LOC,
+    OP_INVENTORY_ADD,
+    OP_INVENTORY_REMOVE,
+    OP_INVENTORY_CLEAR,
+    OP_VIEW_INVENTORY,
+    OP_RENDER_ASCII,
+    OP_RENDER_HEX,
+    OP_COUNT
+};
+
+static FILE *fuzz_out;
+static uintptr_t heap_lo;
+static uint64_t fuzz_stale_runs;
+
+// ============================================================================
+// INPUT DECODING
+// ============================================================================
+// Reads past the end yield zeros, so every input decodes to something.
+typedef struct fuzz_cursor {
+    const uint8_t *p, *end;
+} fuzz_cursor;
+
+static uint8_t take_u8(fuzz_cursor *c) {
+    return c->p < c->end ? *c->p++ : 0;
+}
+
+// A length byte, then up to MAX_LENGTH-1 bytes of the string.
+static void take_str(fuzz_cursor *c, char out[MAX_LENGTH]) {
+    size_t n = take_u8(c) % MAX_LENGTH;
+    if (n > (size_t)(c->end - c->p)) n = (size_t)(c->end - c->p);
+    memcpy(out, c->p, n);
+    out[n] = '\0';
+    c->p += n;
+}
+
+// Logins: the selector's top bit picks a Black Sun member by its low bits,
+// the next one whether the member's access code is used as is.
+static void take_login(fuzz_cursor *c, char username[MAX_LENGTH], char access_code[MAX_LENGTH]) {
+    uint8_t sel = take_u8(c);
+    if (sel & 0x80) {
+        int i = sel % NUM_BLACK_SUN_MEMBERS;
+        snprintf(username, MAX_LENGTH, "%s", black_sun_member_usernames[i]);
+        if (sel & 0x40)
+            snprintf(access_code, MAX_LENGTH, "%s", black_sun_member_access_codes[i]);
+        else
+            take_str(c, access_code);
+    } else {
+        take_str(c, username);
+        take_str(c, access_code);
+    }
+}
+
+// Start locations: a Street port number or a custom name.
+static void take_location(fuzz_cursor *c, char name[MAX_LENGTH]) {
+    uint8_t sel = take_u8(c);
+    if (sel & 0x80)
+        snprintf(name, MAX_LENGTH, "%u", take_u8(c));
+    else
+        take_str(c, name);
+}
+
+static long take_obj(fuzz_cursor *c) {
+    uint8_t hi = take_u8(c);
+    return (int16_t)(hi << 8 | take_u8(c));
+}
+
+// ============================================================================
+// ORACLE
+// ============================================================================
+// Chunks come from glibc's main arena, the [heap] mapping, which starts at
+// heap_lo and grows up to sbrk(0).
+static int heap_start(uintptr_t *lo) {
+    FILE *f = fopen("/proc/self/maps", "r");
+    if (!f) return -1;
+    char line[512];
+    int rc = -1;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long a;
+        if (strstr(line, "[heap]") && sscanf(line, "%lx-", &a) == 1) {
+            *lo = a;
+            rc = 0;
+            break;
+        }
+    }
+    fclose(f);
+    return rc;
+}
+
+static int in_heap(uintptr_t v) {
+    return heap_lo && v >= heap_lo && v < (uintptr_t)sbrk(0);
+}
+
+// A username the input spelled out can look like a heap address by chance;
+// KLEE skips such values as still symbolic, here they are found in the input.
+static int from_input(const uint8_t *data, size_t size, uintptr_t v) {
+    uint8_t b[sizeof(v)];
+    memcpy(b, &v, sizeof(v));
+    size_t n = sizeof(v);
+    while (n && !b[n - 1]) n--;
+    for (size_t i = 0; n && i + n <= size; i++)
+        if (memcmp(data + i, b, n) == 0) return 1;
+    return 0;
+}
+
+static void report_leak(const uint8_t *data, size_t size, const avatar *av, uintptr_t leaked, int op) {
+    fprintf(stderr, "[FUZZ] leak after op %d: avatar %p username bytes 0x%016lx in heap [0x%lx, 0x%lx)\n",
+            op, (void *)av, (unsigned long)leaked, (unsigned long)heap_lo, (unsigned long)(uintptr_t)sbrk(0));
+#ifndef WMI2_LIBFUZZER
+    // libFuzzer saves the input itself when the run aborts.
+    FILE *f = fopen("leak-wmi2.bin", "wb");
+    if (f) {
+        fwrite(data, 1, size, f);
+        fclose(f);
+        fprintf(stderr, "[FUZZ] input written to leak-wmi2.bin\n");
+    }
+#else
+    (void)data;
+    (void)size;
+#endif
+    abort();
+}
+
+// ============================================================================
+// ONE RUN
+// ============================================================================
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    (void)argc;
+    (void)argv;
+    fuzz_out = fopen("/dev/null", "w");
+    if (!fuzz_out) {
+        perror("/dev/null");
+        exit(1);
+    }
+    // init_system prints its banner to stdout.
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    dup2(fileno(fuzz_out), STDOUT_FILENO);
+    init_system();
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    // init_system has allocated, so the arena exists by now.
+    if (heap_start(&heap_lo) < 0) {
+        fprintf(stderr, "[ERROR] No [heap] mapping; the leak oracle needs glibc malloc\n");
+        exit(1);
+    }
+    return 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    fuzz_cursor c = { data, data + size };
+    session_h sess = session_open();
+    session *s = session_get(sess);
+    if (!s) {
+        printf("[ERROR] Memory allocation failed\n");
+        exit(1);
+    }
+    s->out = fuzz_out;
+
+    char a[MAX_LENGTH], b[MAX_LENGTH];
+    long obj;
+    int went_stale = 0;
+    for (int op = 0; op < FUZZ_MAX_OPS && c.p < c.end; op++) {
+        switch (take_u8(&c) % OP_COUNT) {
+        case OP_SET_AVATAR:
+            take_login(&c, a, b);
+            set_avatar(sess, a, b);
+            break;
+        case OP_CLEAR_AVATAR:
+            clear_avatar(sess);
+            break;
+        case OP_SET_START_LOC:
+            take_location(&c, a);
+            set_start_location_name(sess, a);
+            break;
+        case OP_CLEAR_START_LOC:
+            clear_start_location(sess);
+            break;
+        case OP_INVENTORY_ADD:
+            take_str(&c, a);
+            obj = take_obj(&c);
+            inventory_add(sess, a, obj);
+            break;
+        case OP_INVENTORY_REMOVE:
+            obj = take_obj(&c);
+            inventory_remove_by_obj(sess, obj);
+            break;
+        case OP_INVENTORY_CLEAR:
+            inventory_clear_all(sess);
+            break;
+        case OP_VIEW_INVENTORY:
+            view_inventory(sess);
+            break;
+        case OP_RENDER_ASCII:
+            render_ascii(sess);
+            break;
+        case OP_RENDER_HEX:
+            render_hex(sess);
+            break;
+        }
+        // clear_avatar, or a denied login over a loaded avatar, frees the
+        // avatar and keeps its handle: WMI-2.
+        if (s->is_active && s->avatar_released) {
+            avatar *av = avatar_get(s->current_avatar);
+            uintptr_t leaked;
+            went_stale = 1;
+            if (av && wmi2_leaks(av, in_heap, &leaked) && !from_input(data, size, leaked))
+                report_leak(data, size, av, leaked, op);
+        }
+    }
+
+    fuzz_stale_runs += went_stale;
+    session_close(sess);
+    return 0;
+}
+
+// ============================================================================
+// STANDALONE DRIVER
+// ============================================================================
+// Without libFuzzer: reruns the files given, or runs -n random inputs. The
+// random mode has no coverage feedback; it measures the harness and smokes
+// out crashes, it does not search.
+#ifndef WMI2_LIBFUZZER
+static uint64_t rng_state;
+
+static uint64_t rng_next(void) {
+    uint64_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return rng_state = x;
+}
+
+static int run_file(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    uint8_t buf[4096];
+    size_t n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    LLVMFuzzerTestOneInput(buf, n);
+    printf("%s: %zu bytes, no leak\n", path, n);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    uint64_t runs = 0, seed = 1;
+    int first = 1;
+    while (first + 1 < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "-n") == 0)
+            runs = strtoull(argv[first + 1], NULL, 10);
+        else if (strcmp(argv[first], "-s") == 0)
+            seed = strtoull(argv[first + 1], NULL, 10);
+        else
+            break;
+        first += 2;
+    }
+    if (!runs && first >= argc) {
+        fprintf(stderr, "usage: %s -n runs [-s seed] | input...\n", argv[0]);
+        return 2;
+    }
+    LLVMFuzzerInitialize(&argc, &argv);
+
+    int rc = 0;
+    for (int i = first; i < argc; i++)
+        if (run_file(argv[i]) < 0) rc = 1;
+    if (!runs) return rc;
+
+    rng_state = seed ? seed : 1;
+    uint8_t buf[256];
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint64_t r = 0; r < runs; r++) {
+        size_t n = rng_next() % sizeof(buf);
+        for (size_t i = 0; i < n; i += 8) {
+            uint64_t w = rng_next();
+            memcpy(buf + i, &w, n - i < 8 ? n - i : 8);
+        }
+        LLVMFuzzerTestOneInput(buf, n);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double secs = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("[FUZZ] %llu runs in %.3f s (%.0f/s): %llu with a stale avatar, no leak\n",
+           (unsigned long long)runs, secs, secs > 0 ? (double)runs / secs : 0.0,
+           (unsigned long long)fuzz_stale_runs);
+    return rc;
+}
+#endif
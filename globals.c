@@ -15,3 +15,282 @@ const char *black_sun_member_access_codes[] = {
     "egg_whites",
     "lb_of_Bacon"
 };
+
+// Perfect-hash table over the members above, used by blacksun.c until a
+// directory file is loaded. Regenerate when they change:
+//   cc -I. blacksun_gen.c blacksun.c globals.c -pthread -o blacksun_gen && ./blacksun_gen
+// Generated by blacksun_gen - do not edit.
+static const uint32_t black_sun_builtin_seeds[] = { 5, 0 };
+
+static const bs_member black_sun_builtin_slots[] = {
+    { "juanita_m", 9, "Innana", 6 },
+    { "da5id_m", 7, "LA_castle", 9 },
+    { "vitaly_c", 8, "egg_whites", 10 },
+    { "hiro_p", 6, "lb_of_Bacon", 11 },
+};
+
+const bs_directory black_sun_builtin_directory = {
+    4, 2, black_sun_builtin_seeds, black_sun_builtin_slots, NULL, 0
+};
+
+// Street port catalog: start_loc points into it instead of copying. Regenerate
+// with: cc -I. port_gen.c -lm -o port_gen && ./port_gen
+// Generated by port_gen - do not edit.
+const port_entry port_catalog[NUM_PORTS] = {
+    { "0", { 0xA8, 0xBE, 0x60, 0xDC, 0x80, 0x00, 0x00, 0x00 } },
+    { "1", { 0xA8, 0xBB, 0x3C, 0xA6, 0x80, 0xFF, 0xF9, 0x6C } },
+    { "2", { 0xA8, 0xB1, 0xD0, 0x83, 0x81, 0xFF, 0xCB, 0x5E } },
+    { "3", { 0xA8, 0xA2, 0x1D, 0xE6, 0x82, 0xFF, 0x4E, 0x65 } },
+    { "4", { 0xA8, 0x8C, 0x27, 0x3A, 0x83, 0xFE, 0x5B, 0x1A } },
+    { "5", { 0xA8, 0x6F, 0xEF, 0xE3, 0x84, 0xFC, 0xCA, 0x27 } },
+    { "6", { 0xA8, 0x4D, 0x7C, 0x3A, 0x85, 0xFA, 0x74, 0x51 } },
+    { "7", { 0xA8, 0x24, 0xD1, 0x8F, 0x86, 0xF7, 0x32, 0x7B } },
+    { "8", { 0xA7, 0xF5, 0xF6, 0x28, 0x87, 0xF2, 0xDD, 0xAA } },
+    { "9", { 0xA7, 0xC0, 0xF1, 0x3F, 0x88, 0xED, 0x4F, 0x10 } },
+    { "10", { 0xA7, 0x85, 0xCB, 0x01, 0x89, 0xE6, 0x60, 0x0E } },
+    { "11", { 0xA7, 0x44, 0x8C, 0x8C, 0x8A, 0xDD, 0xEA, 0x3C } },
+    { "12", { 0xA6, 0xFD, 0x3F, 0xF0, 0x8B, 0xD3, 0xC7, 0x6D } },
+    { "13", { 0xA6, 0xAF, 0xF0, 0x2C, 0x8C, 0xC7, 0xD1, 0xB9 } },
+    { "14", { 0xA6, 0x5C, 0xA9, 0x2C, 0x8D, 0xB9, 0xE3, 0x7D } },
+    { "15", { 0xA6, 0x03, 0x77, 0xC8, 0x8E, 0xA9, 0xD7, 0x66 } },
+    { "16", { 0xA5, 0xA4, 0x69, 0xBF, 0x8F, 0x97, 0x88, 0x72 } },
+    { "17", { 0xA5, 0x3F, 0x8D, 0xBC, 0x90, 0x82, 0xD1, 0xFA } },
+    { "18", { 0xA4, 0xD4, 0xF3, 0x4A, 0x91, 0x6B, 0x8F, 0xB7 } },
+    { "19", { 0xA4, 0x64, 0xAA, 0xDC, 0x92, 0x51, 0x9D, 0xC4 } },
+    { "20", { 0xA3, 0xEE, 0xC5, 0xC0, 0x93, 0x34, 0xD8, 0xA8 } },
+    { "21", { 0xA3, 0x73, 0x56, 0x26, 0x94, 0x15, 0x1D, 0x59 } },
+    { "22", { 0xA2, 0xF2, 0x6F, 0x16, 0x94, 0xF2, 0x49, 0x40 } },
+    { "23", { 0xA2, 0x6C, 0x24, 0x70, 0x95, 0xCC, 0x3A, 0x43 } },
+    { "24", { 0xA1, 0xE0, 0x8A, 0xEB, 0x96, 0xA2, 0xCE, 0xC7 } },
+    { "25", { 0xA1, 0x4F, 0xB8, 0x0C, 0x97, 0x75, 0xE5, 0xB5 } },
+    { "26", { 0xA0, 0xB9, 0xC2, 0x2A, 0x98, 0x45, 0x5E, 0x7F } },
+    { "27", { 0xA0, 0x1E, 0xC0, 0x63, 0x99, 0x11, 0x19, 0x28 } },
+    { "28", { 0x9F, 0x7E, 0xCA, 0xA0, 0x99, 0xD8, 0xF6, 0x44 } },
+    { "29", { 0x9E, 0xD9, 0xF9, 0x8A, 0x9A, 0x9C, 0xD7, 0x02 } },
+    { "30", { 0x9E, 0x30, 0x66, 0x8C, 0x9B, 0x5C, 0x9D, 0x2E } },
+    { "31", { 0x9D, 0x82, 0x2B, 0xCD, 0x9C, 0x18, 0x2B, 0x34 } },
+    { "32", { 0x9C, 0xCF, 0x64, 0x2A, 0x9C, 0xCF, 0x64, 0x2A } },
+    { "33", { 0x9C, 0x18, 0x2B, 0x34, 0x9D, 0x82, 0x2B, 0xCD } },
+    { "34", { 0x9B, 0x5C, 0x9D, 0x2E, 0x9E, 0x30, 0x66, 0x8C } },
+    { "35", { 0x9A, 0x9C, 0xD7, 0x02, 0x9E, 0xD9, 0xF9, 0x8A } },
+    { "36", { 0x99, 0xD8, 0xF6, 0x44, 0x9F, 0x7E, 0xCA, 0xA0 } },
+    { "37", { 0x99, 0x11, 0x19, 0x28, 0xA0, 0x1E, 0xC0, 0x63 } },
+    { "38", { 0x98, 0x45, 0x5E, 0x7F, 0xA0, 0xB9, 0xC2, 0x2A } },
+    { "39", { 0x97, 0x75, 0xE5, 0xB5, 0xA1, 0x4F, 0xB8, 0x0C } },
+    { "40", { 0x96, 0xA2, 0xCE, 0xC7, 0xA1, 0xE0, 0x8A, 0xEB } },
+    { "41", { 0x95, 0xCC, 0x3A, 0x43, 0xA2, 0x6C, 0x24, 0x70 } },
+    { "42", { 0x94, 0xF2, 0x49, 0x40, 0xA2, 0xF2, 0x6F, 0x16 } },
+    { "43", { 0x94, 0x15, 0x1D, 0x59, 0xA3, 0x73, 0x56, 0x26 } },
+    { "44", { 0x93, 0x34, 0xD8, 0xA8, 0xA3, 0xEE, 0xC5, 0xC0 } },
+    { "45", { 0x92, 0x51, 0x9D, 0xC4, 0xA4, 0x64, 0xAA, 0xDC } },
+    { "46", { 0x91, 0x6B, 0x8F, 0xB7, 0xA4, 0xD4, 0xF3, 0x4A } },
+    { "47", { 0x90, 0x82, 0xD1, 0xFA, 0xA5, 0x3F, 0x8D, 0xBC } },
+    { "48", { 0x8F, 0x97, 0x88, 0x72, 0xA5, 0xA4, 0x69, 0xBF } },
+    { "49", { 0x8E, 0xA9, 0xD7, 0x66, 0xA6, 0x03, 0x77, 0xC8 } },
+    { "50", { 0x8D, 0xB9, 0xE3, 0x7D, 0xA6, 0x5C, 0xA9, 0x2C } },
+    { "51", { 0x8C, 0xC7, 0xD1, 0xB9, 0xA6, 0xAF, 0xF0, 0x2C } },
+    { "52", { 0x8B, 0xD3, 0xC7, 0x6D, 0xA6, 0xFD, 0x3F, 0xF0 } },
+    { "53", { 0x8A, 0xDD, 0xEA, 0x3C, 0xA7, 0x44, 0x8C, 0x8C } },
+    { "54", { 0x89, 0xE6, 0x60, 0x0E, 0xA7, 0x85, 0xCB, 0x01 } },
+    { "55", { 0x88, 0xED, 0x4F, 0x10, 0xA7, 0xC0, 0xF1, 0x3F } },
+    { "56", { 0x87, 0xF2, 0xDD, 0xAA, 0xA7, 0xF5, 0xF6, 0x28 } },
+    { "57", { 0x86, 0xF7, 0x32, 0x7B, 0xA8, 0x24, 0xD1, 0x8F } },
+    { "58", { 0x85, 0xFA, 0x74, 0x51, 0xA8, 0x4D, 0x7C, 0x3A } },
+    { "59", { 0x84, 0xFC, 0xCA, 0x27, 0xA8, 0x6F, 0xEF, 0xE3 } },
+    { "60", { 0x83, 0xFE, 0x5B, 0x1A, 0xA8, 0x8C, 0x27, 0x3A } },
+    { "61", { 0x82, 0xFF, 0x4E, 0x65, 0xA8, 0xA2, 0x1D, 0xE6 } },
+    { "62", { 0x81, 0xFF, 0xCB, 0x5E, 0xA8, 0xB1, 0xD0, 0x83 } },
+    { "63", { 0x80, 0xFF, 0xF9, 0x6C, 0xA8, 0xBB, 0x3C, 0xA6 } },
+    { "64", { 0x80, 0x00, 0x00, 0x00, 0xA8, 0xBE, 0x60, 0xDC } },
+    { "65", { 0x7F, 0x00, 0x06, 0x94, 0xA8, 0xBB, 0x3C, 0xA6 } },
+    { "66", { 0x7E, 0x00, 0x34, 0xA2, 0xA8, 0xB1, 0xD0, 0x83 } },
+    { "67", { 0x7D, 0x00, 0xB1, 0x9B, 0xA8, 0xA2, 0x1D, 0xE6 } },
+    { "68", { 0x7C, 0x01, 0xA4, 0xE6, 0xA8, 0x8C, 0x27, 0x3A } },
+    { "69", { 0x7B, 0x03, 0x35, 0xD9, 0xA8, 0x6F, 0xEF, 0xE3 } },
+    { "70", { 0x7A, 0x05, 0x8B, 0xAF, 0xA8, 0x4D, 0x7C, 0x3A } },
+    { "71", { 0x79, 0x08, 0xCD, 0x85, 0xA8, 0x24, 0xD1, 0x8F } },
+    { "72", { 0x78, 0x0D, 0x22, 0x56, 0xA7, 0xF5, 0xF6, 0x28 } },
+    { "73", { 0x77, 0x12, 0xB0, 0xF0, 0xA7, 0xC0, 0xF1, 0x3F } },
+    { "74", { 0x76, 0x19, 0x9F, 0xF2, 0xA7, 0x85, 0xCB, 0x01 } },
+    { "75", { 0x75, 0x22, 0x15, 0xC4, 0xA7, 0x44, 0x8C, 0x8C } },
+    { "76", { 0x74, 0x2C, 0x38, 0x93, 0xA6, 0xFD, 0x3F, 0xF0 } },
+    { "77", { 0x73, 0x38, 0x2E, 0x47, 0xA6, 0xAF, 0xF0, 0x2C } },
+    { "78", { 0x72, 0x46, 0x1C, 0x83, 0xA6, 0x5C, 0xA9, 0x2C } },
+    { "79", { 0x71, 0x56, 0x28, 0x9A, 0xA6, 0x03, 0x77, 0xC8 } },
+    { "80", { 0x70, 0x68, 0x77, 0x8E, 0xA5, 0xA4, 0x69, 0xBF } },
+    { "81", { 0x6F, 0x7D, 0x2E, 0x06, 0xA5, 0x3F, 0x8D, 0xBC } },
+    { "82", { 0x6E, 0x94, 0x70, 0x49, 0xA4, 0xD4, 0xF3, 0x4A } },
+    { "83", { 0x6D, 0xAE, 0x62, 0x3C, 0xA4, 0x64, 0xAA, 0xDC } },
+    { "84", { 0x6C, 0xCB, 0x27, 0x58, 0xA3, 0xEE, 0xC5, 0xC0 } },
+    { "85", { 0x6B, 0xEA, 0xE2, 0xA7, 0xA3, 0x73, 0x56, 0x26 } },
+    { "86", { 0x6B, 0x0D, 0xB6, 0xC0, 0xA2, 0xF2, 0x6F, 0x16 } },
+    { "87", { 0x6A, 0x33, 0xC5, 0xBD, 0xA2, 0x6C, 0x24, 0x70 } },
+    { "88", { 0x69, 0x5D, 0x31, 0x39, 0xA1, 0xE0, 0x8A, 0xEB } },
+    { "89", { 0x68, 0x8A, 0x1A, 0x4B, 0xA1, 0x4F, 0xB8, 0x0C } },
+    { "90", { 0x67, 0xBA, 0xA1, 0x81, 0xA0, 0xB9, 0xC2, 0x2A } },
+    { "91", { 0x66, 0xEE, 0xE6, 0xD8, 0xA0, 0x1E, 0xC0, 0x63 } },
+    { "92", { 0x66, 0x27, 0x09, 0xBC, 0x9F, 0x7E, 0xCA, 0xA0 } },
+    { "93", { 0x65, 0x63, 0x28, 0xFE, 0x9E, 0xD9, 0xF9, 0x8A } },
+    { "94", { 0x64, 0xA3, 0x62, 0xD2, 0x9E, 0x30, 0x66, 0x8C } },
+    { "95", { 0x63, 0xE7, 0xD4, 0xCC, 0x9D, 0x82, 0x2B, 0xCD } },
+    { "96", { 0x63, 0x30, 0x9B, 0xD6, 0x9C, 0xCF, 0x64, 0x2A } },
+    { "97", { 0x62, 0x7D, 0xD4, 0x33, 0x9C, 0x18, 0x2B, 0x34 } },
+    { "98", { 0x61, 0xCF, 0x99, 0x74, 0x9B, 0x5C, 0x9D, 0x2E } },
+    { "99", { 0x61, 0x26, 0x06, 0x76, 0x9A, 0x9C, 0xD7, 0x02 } },
+    { "100", { 0x60, 0x81, 0x35, 0x60, 0x99, 0xD8, 0xF6, 0x44 } },
+    { "101", { 0x5F, 0xE1, 0x3F, 0x9D, 0x99, 0x11, 0x19, 0x28 } },
+    { "102", { 0x5F, 0x46, 0x3D, 0xD6, 0x98, 0x45, 0x5E, 0x7F } },
+    { "103", { 0x5E, 0xB0, 0x47, 0xF4, 0x97, 0x75, 0xE5, 0xB5 } },
+    { "104", { 0x5E, 0x1F, 0x75, 0x15, 0x96, 0xA2, 0xCE, 0xC7 } },
+    { "105", { 0x5D, 0x93, 0xDB, 0x90, 0x95, 0xCC, 0x3A, 0x43 } },
+    { "106", { 0x5D, 0x0D, 0x90, 0xEA, 0x94, 0xF2, 0x49, 0x40 } },
+    { "107", { 0x5C, 0x8C, 0xA9, 0xDA, 0x94, 0x15, 0x1D, 0x59 } },
+    { "108", { 0x5C, 0x11, 0x3A, 0x40, 0x93, 0x34, 0xD8, 0xA8 } },
+    { "109", { 0x5B, 0x9B, 0x55, 0x24, 0x92, 0x51, 0x9D, 0xC4 } },
+    { "110", { 0x5B, 0x2B, 0x0C, 0xB6, 0x91, 0x6B, 0x8F, 0xB7 } },
+    { "111", { 0x5A, 0xC0, 0x72, 0x44, 0x90, 0x82, 0xD1, 0xFA } },
+    { "112", { 0x5A, 0x5B, 0x96, 0x41, 0x8F, 0x97, 0x88, 0x72 } },
+    { "113", { 0x59, 0xFC, 0x88, 0x38, 0x8E, 0xA9, 0xD7, 0x66 } },
+    { "114", { 0x59, 0xA3, 0x56, 0xD4, 0x8D, 0xB9, 0xE3, 0x7D } },
+    { "115", { 0x59, 0x50, 0x0F, 0xD4, 0x8C, 0xC7, 0xD1, 0xB9 } },
+    { "116", { 0x59, 0x02, 0xC0, 0x10, 0x8B, 0xD3, 0xC7, 0x6D } },
+    { "117", { 0x58, 0xBB, 0x73, 0x74, 0x8A, 0xDD, 0xEA, 0x3C } },
+    { "118", { 0x58, 0x7A, 0x34, 0xFF, 0x89, 0xE6, 0x60, 0x0E } },
+    { "119", { 0x58, 0x3F, 0x0E, 0xC1, 0x88, 0xED, 0x4F, 0x10 } },
+    { "120", { 0x58, 0x0A, 0x09, 0xD8, 0x87, 0xF2, 0xDD, 0xAA } },
+    { "121", { 0x57, 0xDB, 0x2E, 0x71, 0x86, 0xF7, 0x32, 0x7B } },
+    { "122", { 0x57, 0xB2, 0x83, 0xC6, 0x85, 0xFA, 0x74, 0x51 } },
+    { "123", { 0x57, 0x90, 0x10, 0x1D, 0x84, 0xFC, 0xCA, 0x27 } },
+    { "124", { 0x57, 0x73, 0xD8, 0xC6, 0x83, 0xFE, 0x5B, 0x1A } },
+    { "125", { 0x57, 0x5D, 0xE2, 0x1A, 0x82, 0xFF, 0x4E, 0x65 } },
+    { "126", { 0x57, 0x4E, 0x2F, 0x7D, 0x81, 0xFF, 0xCB, 0x5E } },
+    { "127", { 0x57, 0x44, 0xC3, 0x5A, 0x80, 0xFF, 0xF9, 0x6C } },
+    { "128", { 0x57, 0x41, 0x9F, 0x24, 0x80, 0x00, 0x00, 0x00 } },
+    { "129", { 0x57, 0x44, 0xC3, 0x5A, 0x7F, 0x00, 0x06, 0x94 } },
+    { "130", { 0x57, 0x4E, 0x2F, 0x7D, 0x7E, 0x00, 0x34, 0xA2 } },
+    { "131", { 0x57, 0x5D, 0xE2, 0x1A, 0x7D, 0x00, 0xB1, 0x9B } },
+    { "132", { 0x57, 0x73, 0xD8, 0xC6, 0x7C, 0x01, 0xA4, 0xE6 } },
+    { "133", { 0x57, 0x90, 0x10, 0x1D, 0x7B, 0x03, 0x35, 0xD9 } },
+    { "134", { 0x57, 0xB2, 0x83, 0xC6, 0x7A, 0x05, 0x8B, 0xAF } },
+    { "135", { 0x57, 0xDB, 0x2E, 0x71, 0x79, 0x08, 0xCD, 0x85 } },
+    { "136", { 0x58, 0x0A, 0x09, 0xD8, 0x78, 0x0D, 0x22, 0x56 } },
+    { "137", { 0x58, 0x3F, 0x0E, 0xC1, 0x77, 0x12, 0xB0, 0xF0 } },
+    { "138", { 0x58, 0x7A, 0x34, 0xFF, 0x76, 0x19, 0x9F, 0xF2 } },
+    { "139", { 0x58, 0xBB, 0x73, 0x74, 0x75, 0x22, 0x15, 0xC4 } },
+    { "140", { 0x59, 0x02, 0xC0, 0x10, 0x74, 0x2C, 0x38, 0x93 } },
+    { "141", { 0x59, 0x50, 0x0F, 0xD4, 0x73, 0x38, 0x2E, 0x47 } },
+    { "142", { 0x59, 0xA3, 0x56, 0xD4, 0x72, 0x46, 0x1C, 0x83 } },
+    { "143", { 0x59, 0xFC, 0x88, 0x38, 0x71, 0x56, 0x28, 0x9A } },
+    { "144", { 0x5A, 0x5B, 0x96, 0x41, 0x70, 0x68, 0x77, 0x8E } },
+    { "145", { 0x5A, 0xC0, 0x72, 0x44, 0x6F, 0x7D, 0x2E, 0x06 } },
+    { "146", { 0x5B, 0x2B, 0x0C, 0xB6, 0x6E, 0x94, 0x70, 0x49 } },
+    { "147", { 0x5B, 0x9B, 0x55, 0x24, 0x6D, 0xAE, 0x62, 0x3C } },
+    { "148", { 0x5C, 0x11, 0x3A, 0x40, 0x6C, 0xCB, 0x27, 0x58 } },
+    { "149", { 0x5C, 0x8C, 0xA9, 0xDA, 0x6B, 0xEA, 0xE2, 0xA7 } },
+    { "150", { 0x5D, 0x0D, 0x90, 0xEA, 0x6B, 0x0D, 0xB6, 0xC0 } },
+    { "151", { 0x5D, 0x93, 0xDB, 0x90, 0x6A, 0x33, 0xC5, 0xBD } },
+    { "152", { 0x5E, 0x1F, 0x75, 0x15, 0x69, 0x5D, 0x31, 0x39 } },
+    { "153", { 0x5E, 0xB0, 0x47, 0xF4, 0x68, 0x8A, 0x1A, 0x4B } },
+    { "154", { 0x5F, 0x46, 0x3D, 0xD6, 0x67, 0xBA, 0xA1, 0x81 } },
+    { "155", { 0x5F, 0xE1, 0x3F, 0x9D, 0x66, 0xEE, 0xE6, 0xD8 } },
+    { "156", { 0x60, 0x81, 0x35, 0x60, 0x66, 0x27, 0x09, 0xBC } },
+    { "157", { 0x61, 0x26, 0x06, 0x76, 0x65, 0x63, 0x28, 0xFE } },
+    { "158", { 0x61, 0xCF, 0x99, 0x74, 0x64, 0xA3, 0x62, 0xD2 } },
+    { "159", { 0x62, 0x7D, 0xD4, 0x33, 0x63, 0xE7, 0xD4, 0xCC } },
+    { "160", { 0x63, 0x30, 0x9B, 0xD6, 0x63, 0x30, 0x9B, 0xD6 } },
+    { "161", { 0x63, 0xE7, 0xD4, 0xCC, 0x62, 0x7D, 0xD4, 0x33 } },
+    { "162", { 0x64, 0xA3, 0x62, 0xD2, 0x61, 0xCF, 0x99, 0x74 } },
+    { "163", { 0x65, 0x63, 0x28, 0xFE, 0x61, 0x26, 0x06, 0x76 } },
+    { "164", { 0x66, 0x27, 0x09, 0xBC, 0x60, 0x81, 0x35, 0x60 } },
+    { "165", { 0x66, 0xEE, 0xE6, 0xD8, 0x5F, 0xE1, 0x3F, 0x9D } },
+    { "166", { 0x67, 0xBA, 0xA1, 0x81, 0x5F, 0x46, 0x3D, 0xD6 } },
+    { "167", { 0x68, 0x8A, 0x1A, 0x4B, 0x5E, 0xB0, 0x47, 0xF4 } },
+    { "168", { 0x69, 0x5D, 0x31, 0x39, 0x5E, 0x1F, 0x75, 0x15 } },
+    { "169", { 0x6A, 0x33, 0xC5, 0xBD, 0x5D, 0x93, 0xDB, 0x90 } },
+    { "170", { 0x6B, 0x0D, 0xB6, 0xC0, 0x5D, 0x0D, 0x90, 0xEA } },
+    { "171", { 0x6B, 0xEA, 0xE2, 0xA7, 0x5C, 0x8C, 0xA9, 0xDA } },
+    { "172", { 0x6C, 0xCB, 0x27, 0x58, 0x5C, 0x11, 0x3A, 0x40 } },
+    { "173", { 0x6D, 0xAE, 0x62, 0x3C, 0x5B, 0x9B, 0x55, 0x24 } },
+    { "174", { 0x6E, 0x94, 0x70, 0x49, 0x5B, 0x2B, 0x0C, 0xB6 } },
+    { "175", { 0x6F, 0x7D, 0x2E, 0x06, 0x5A, 0xC0, 0x72, 0x44 } },
+    { "176", { 0x70, 0x68, 0x77, 0x8E, 0x5A, 0x5B, 0x96, 0x41 } },
+    { "177", { 0x71, 0x56, 0x28, 0x9A, 0x59, 0xFC, 0x88, 0x38 } },
+    { "178", { 0x72, 0x46, 0x1C, 0x83, 0x59, 0xA3, 0x56, 0xD4 } },
+    { "179", { 0x73, 0x38, 0x2E, 0x47, 0x59, 0x50, 0x0F, 0xD4 } },
+    { "180", { 0x74, 0x2C, 0x38, 0x93, 0x59, 0x02, 0xC0, 0x10 } },
+    { "181", { 0x75, 0x22, 0x15, 0xC4, 0x58, 0xBB, 0x73, 0x74 } },
+    { "182", { 0x76, 0x19, 0x9F, 0xF2, 0x58, 0x7A, 0x34, 0xFF } },
+    { "183", { 0x77, 0x12, 0xB0, 0xF0, 0x58, 0x3F, 0x0E, 0xC1 } },
+    { "184", { 0x78, 0x0D, 0x22, 0x56, 0x58, 0x0A, 0x09, 0xD8 } },
+    { "185", { 0x79, 0x08, 0xCD, 0x85, 0x57, 0xDB, 0x2E, 0x71 } },
+    { "186", { 0x7A, 0x05, 0x8B, 0xAF, 0x57, 0xB2, 0x83, 0xC6 } },
+    { "187", { 0x7B, 0x03, 0x35, 0xD9, 0x57, 0x90, 0x10, 0x1D } },
+    { "188", { 0x7C, 0x01, 0xA4, 0xE6, 0x57, 0x73, 0xD8, 0xC6 } },
+    { "189", { 0x7D, 0x00, 0xB1, 0x9B, 0x57, 0x5D, 0xE2, 0x1A } },
+    { "190", { 0x7E, 0x00, 0x34, 0xA2, 0x57, 0x4E, 0x2F, 0x7D } },
+    { "191", { 0x7F, 0x00, 0x06, 0x94, 0x57, 0x44, 0xC3, 0x5A } },
+    { "192", { 0x80, 0x00, 0x00, 0x00, 0x57, 0x41, 0x9F, 0x24 } },
+    { "193", { 0x80, 0xFF, 0xF9, 0x6C, 0x57, 0x44, 0xC3, 0x5A } },
+    { "194", { 0x81, 0xFF, 0xCB, 0x5E, 0x57, 0x4E, 0x2F, 0x7D } },
+    { "195", { 0x82, 0xFF, 0x4E, 0x65, 0x57, 0x5D, 0xE2, 0x1A } },
+    { "196", { 0x83, 0xFE, 0x5B, 0x1A, 0x57, 0x73, 0xD8, 0xC6 } },
+    { "197", { 0x84, 0xFC, 0xCA, 0x27, 0x57, 0x90, 0x10, 0x1D } },
+    { "198", { 0x85, 0xFA, 0x74, 0x51, 0x57, 0xB2, 0x83, 0xC6 } },
+    { "199", { 0x86, 0xF7, 0x32, 0x7B, 0x57, 0xDB, 0x2E, 0x71 } },
+    { "200", { 0x87, 0xF2, 0xDD, 0xAA, 0x58, 0x0A, 0x09, 0xD8 } },
+    { "201", { 0x88, 0xED, 0x4F, 0x10, 0x58, 0x3F, 0x0E, 0xC1 } },
+    { "202", { 0x89, 0xE6, 0x60, 0x0E, 0x58, 0x7A, 0x34, 0xFF } },
+    { "203", { 0x8A, 0xDD, 0xEA, 0x3C, 0x58, 0xBB, 0x73, 0x74 } },
+    { "204", { 0x8B, 0xD3, 0xC7, 0x6D, 0x59, 0x02, 0xC0, 0x10 } },
+    { "205", { 0x8C, 0xC7, 0xD1, 0xB9, 0x59, 0x50, 0x0F, 0xD4 } },
+    { "206", { 0x8D, 0xB9, 0xE3, 0x7D, 0x59, 0xA3, 0x56, 0xD4 } },
+    { "207", { 0x8E, 0xA9, 0xD7, 0x66, 0x59, 0xFC, 0x88, 0x38 } },
+    { "208", { 0x8F, 0x97, 0x88, 0x72, 0x5A, 0x5B, 0x96, 0x41 } },
+    { "209", { 0x90, 0x82, 0xD1, 0xFA, 0x5A, 0xC0, 0x72, 0x44 } },
+    { "210", { 0x91, 0x6B, 0x8F, 0xB7, 0x5B, 0x2B, 0x0C, 0xB6 } },
+    { "211", { 0x92, 0x51, 0x9D, 0xC4, 0x5B, 0x9B, 0x55, 0x24 } },
+    { "212", { 0x93, 0x34, 0xD8, 0xA8, 0x5C, 0x11, 0x3A, 0x40 } },
+    { "213", { 0x94, 0x15, 0x1D, 0x59, 0x5C, 0x8C, 0xA9, 0xDA } },
+    { "214", { 0x94, 0xF2, 0x49, 0x40, 0x5D, 0x0D, 0x90, 0xEA } },
+    { "215", { 0x95, 0xCC, 0x3A, 0x43, 0x5D, 0x93, 0xDB, 0x90 } },
+    { "216", { 0x96, 0xA2, 0xCE, 0xC7, 0x5E, 0x1F, 0x75, 0x15 } },
+    { "217", { 0x97, 0x75, 0xE5, 0xB5, 0x5E, 0xB0, 0x47, 0xF4 } },
+    { "218", { 0x98, 0x45, 0x5E, 0x7F, 0x5F, 0x46, 0x3D, 0xD6 } },
+    { "219", { 0x99, 0x11, 0x19, 0x28, 0x5F, 0xE1, 0x3F, 0x9D } },
+    { "220", { 0x99, 0xD8, 0xF6, 0x44, 0x60, 0x81, 0x35, 0x60 } },
+    { "221", { 0x9A, 0x9C, 0xD7, 0x02, 0x61, 0x26, 0x06, 0x76 } },
+    { "222", { 0x9B, 0x5C, 0x9D, 0x2E, 0x61, 0xCF, 0x99, 0x74 } },
+    { "223", { 0x9C, 0x18, 0x2B, 0x34, 0x62, 0x7D, 0xD4, 0x33 } },
+    { "224", { 0x9C, 0xCF, 0x64, 0x2A, 0x63, 0x30, 0x9B, 0xD6 } },
+    { "225", { 0x9D, 0x82, 0x2B, 0xCD, 0x63, 0xE7, 0xD4, 0xCC } },
+    { "226", { 0x9E, 0x30, 0x66, 0x8C, 0x64, 0xA3, 0x62, 0xD2 } },
+    { "227", { 0x9E, 0xD9, 0xF9, 0x8A, 0x65, 0x63, 0x28, 0xFE } },
+    { "228", { 0x9F, 0x7E, 0xCA, 0xA0, 0x66, 0x27, 0x09, 0xBC } },
+    { "229", { 0xA0, 0x1E, 0xC0, 0x63, 0x66, 0xEE, 0xE6, 0xD8 } },
+    { "230", { 0xA0, 0xB9, 0xC2, 0x2A, 0x67, 0xBA, 0xA1, 0x81 } },
+    { "231", { 0xA1, 0x4F, 0xB8, 0x0C, 0x68, 0x8A, 0x1A, 0x4B } },
+    { "232", { 0xA1, 0xE0, 0x8A, 0xEB, 0x69, 0x5D, 0x31, 0x39 } },
+    { "233", { 0xA2, 0x6C, 0x24, 0x70, 0x6A, 0x33, 0xC5, 0xBD } },
+    { "234", { 0xA2, 0xF2, 0x6F, 0x16, 0x6B, 0x0D, 0xB6, 0xC0 } },
+    { "235", { 0xA3, 0x73, 0x56, 0x26, 0x6B, 0xEA, 0xE2, 0xA7 } },
+    { "236", { 0xA3, 0xEE, 0xC5, 0xC0, 0x6C, 0xCB, 0x27, 0x58 } },
+    { "237", { 0xA4, 0x64, 0xAA, 0xDC, 0x6D, 0xAE, 0x62, 0x3C } },
+    { "238", { 0xA4, 0xD4, 0xF3, 0x4A, 0x6E, 0x94, 0x70, 0x49 } },
+    { "239", { 0xA5, 0x3F, 0x8D, 0xBC, 0x6F, 0x7D, 0x2E, 0x06 } },
+    { "240", { 0xA5, 0xA4, 0x69, 0xBF, 0x70, 0x68, 0x77, 0x8E } },
+    { "241", { 0xA6, 0x03, 0x77, 0xC8, 0x71, 0x56, 0x28, 0x9A } },
+    { "242", { 0xA6, 0x5C, 0xA9, 0x2C, 0x72, 0x46, 0x1C, 0x83 } },
+    { "243", { 0xA6, 0xAF, 0xF0, 0x2C, 0x73, 0x38, 0x2E, 0x47 } },
+    { "244", { 0xA6, 0xFD, 0x3F, 0xF0, 0x74, 0x2C, 0x38, 0x93 } },
+    { "245", { 0xA7, 0x44, 0x8C, 0x8C, 0x75, 0x22, 0x15, 0xC4 } },
+    { "246", { 0xA7, 0x85, 0xCB, 0x01, 0x76, 0x19, 0x9F, 0xF2 } },
+    { "247", { 0xA7, 0xC0, 0xF1, 0x3F, 0x77, 0x12, 0xB0, 0xF0 } },
+    { "248", { 0xA7, 0xF5, 0xF6, 0x28, 0x78, 0x0D, 0x22, 0x56 } },
+    { "249", { 0xA8, 0x24, 0xD1, 0x8F, 0x79, 0x08, 0xCD, 0x85 } },
+    { "250", { 0xA8, 0x4D, 0x7C, 0x3A, 0x7A, 0x05, 0x8B, 0xAF } },
+    { "251", { 0xA8, 0x6F, 0xEF, 0xE3, 0x7B, 0x03, 0x35, 0xD9 } },
+    { "252", { 0xA8, 0x8C, 0x27, 0x3A, 0x7C, 0x01, 0xA4, 0xE6 } },
+    { "253", { 0xA8, 0xA2, 0x1D, 0xE6, 0x7D, 0x00, 0xB1, 0x9B } },
+    { "254", { 0xA8, 0xB1, 0xD0, 0x83, 0x7E, 0x00, 0x34, 0xA2 } },
+    { "255", { 0xA8, 0xBB, 0x3C, 0xA6, 0x7F, 0x00, 0x06, 0x94 } },
+};
@@ -2,167 +2,925 @@
 // 1-Basic: Sample-3 Challenge
 #include "metalogin.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#ifdef METALOGIN_STATS
+// Count heap traffic per call site: each use of these macros gets its own
+// counter slot, labelled with the enclosing function and line.
+#define ML_HEAP_SITE(call, bytes) do { \
+        static _Atomic uint32_t ml_site_; \
+        ml_stats_heap(&ml_site_, __func__, __LINE__, call, (bytes)); \
+    } while (0)
+#undef strdup
+#define malloc(n)         ({ size_t n_ = (n); ML_HEAP_SITE("malloc", n_); malloc(n_); })
+#define calloc(n, sz)     ({ size_t n_ = (size_t)(n) * (sz); ML_HEAP_SITE("calloc", n_); calloc((n), (sz)); })
+#define realloc(p, n)     ({ size_t n_ = (n); ML_HEAP_SITE("realloc", n_); realloc((p), n_); })
+#define aligned_alloc(a, n) ({ size_t n_ = (n); ML_HEAP_SITE("aligned_alloc", n_); aligned_alloc((a), n_); })
+#define strdup(str)       ({ const char *s_ = (str); ML_HEAP_SITE("strdup", strlen(s_) + 1); strdup(s_); })
+#define free(p)           ({ ML_HEAP_SITE("free", 0); free(p); })
+#elif defined(KLEE_DRIVER_BUILD)
+// Every chunk is recorded in the stubs' shadow heap with the function and
+// line that allocated it, for the driver's leak oracle.
+#undef strdup
+#define malloc(n)         shadow_malloc((n), __func__, __LINE__)
+#define calloc(n, sz)     shadow_calloc((n), (sz), __func__, __LINE__)
+#define realloc(p, n)     shadow_realloc((p), (n), __func__, __LINE__)
+#define strdup(str)       shadow_strdup((str), __func__, __LINE__)
+#define free(p)           shadow_free(p)
+#endif
+
 // ============================================================================
 // GLOBAL STATE
 // ============================================================================
-session g_session = {0};
-typedef void (*func_t)(void);
+typedef void (*func_t)(session_h);
 func_t *render_functions;
 
+// ============================================================================
+// OBJECT POOLS
+// ============================================================================
+#ifndef METALOGIN_SYSTEM_ALLOC
+// Pools are process-wide and sharded like the session table: a handle names
+// its shard, so it resolves the same way on every thread, and a slot's
+// generation is read without a lock. Each thread allocates from its own
+// shard; frees go back to the shard the handle names.
+#define POOL_SHARD_BITS   4
+#define POOL_SHARDS       (1u << POOL_SHARD_BITS)
+#define POOL_CHUNK_SLOTS  256
+#define POOL_MAX_CHUNKS   1024
+
+typedef struct pool_shard {
+    _Alignas(ML_CACHE_LINE) atomic_int lock;
+    uint32_t  nslots;
+    uint32_t  free_head;    // slot index + 1, 0 when the free list is empty
+    unsigned char *_Atomic chunks[POOL_MAX_CHUNKS];
+} pool_shard;
+#endif
+
+typedef struct ml_pool {
+    size_t    obj_size;
+    int       stat_type;    // ML_STAT_* for instrumented builds
+    const char *type_name;
+#ifndef METALOGIN_SYSTEM_ALLOC
+    pool_shard shards[POOL_SHARDS];
+#endif
+} ml_pool;
+
+#define POOL_INIT(type, stat) { .obj_size = sizeof(type), .stat_type = stat, .type_name = #type }
+
+static ml_pool avatar_pool = POOL_INIT(avatar, ML_STAT_AVATAR);
+static ml_pool start_loc_pool = POOL_INIT(start_loc, ML_STAT_START_LOC);
+
+#ifndef METALOGIN_SYSTEM_ALLOC
+static atomic_uint pool_next_shard;
+static _Thread_local uint32_t pool_my_shard;    // shard + 1, 0 until first use
+
+// The generation is odd while a slot is live and even while it is free, so
+// a handle is valid iff its generation equals the slot's.
+typedef struct pool_slot {
+    _Atomic uint32_t gen;
+    uint32_t  next_free;
+    uint64_t  reserved;
+    unsigned char obj[];
+} pool_slot;
+
+static size_t pool_slot_size(const ml_pool *p) {
+    return (sizeof(pool_slot) + p->obj_size + 15) & ~(size_t)15;
+}
+
+static pool_slot *pool_slot_at(const ml_pool *p, unsigned char *chunk, uint32_t idx) {
+    return (pool_slot *)(chunk + (size_t)(idx % POOL_CHUNK_SLOTS) * pool_slot_size(p));
+}
+
+static void pool_lock(pool_shard *sh) {
+    while (atomic_exchange_explicit(&sh->lock, 1, memory_order_acquire))
+        ;
+}
+
+static void pool_unlock(pool_shard *sh) {
+    atomic_store_explicit(&sh->lock, 0, memory_order_release);
+}
+
+static ml_handle pool_alloc(ml_pool *p) {
+    if (!pool_my_shard)
+        pool_my_shard = atomic_fetch_add_explicit(&pool_next_shard, 1, memory_order_relaxed)
+                        % POOL_SHARDS + 1;
+    uint32_t shard = pool_my_shard - 1;
+    pool_shard *sh = &p->shards[shard];
+    unsigned char *chunk;
+    uint32_t idx;
+
+    pool_lock(sh);
+    if (sh->free_head) {
+        idx = sh->free_head - 1;
+        chunk = atomic_load_explicit(&sh->chunks[idx / POOL_CHUNK_SLOTS], memory_order_relaxed);
+        sh->free_head = pool_slot_at(p, chunk, idx)->next_free;
+    } else {
+        if (sh->nslots == POOL_MAX_CHUNKS * POOL_CHUNK_SLOTS) {
+            pool_unlock(sh);
+            return ML_NULL_HANDLE;
+        }
+        idx = sh->nslots;
+        chunk = atomic_load_explicit(&sh->chunks[idx / POOL_CHUNK_SLOTS], memory_order_relaxed);
+        if (!chunk) {
+            chunk = calloc(POOL_CHUNK_SLOTS, pool_slot_size(p));
+            if (!chunk) {
+                pool_unlock(sh);
+                return ML_NULL_HANDLE;
+            }
+            atomic_store_explicit(&sh->chunks[idx / POOL_CHUNK_SLOTS], chunk,
+                                  memory_order_release);
+        }
+        sh->nslots++;
+    }
+    pool_slot *sl = pool_slot_at(p, chunk, idx);
+    memset(sl->obj, 0, p->obj_size);
+    uint32_t gen = atomic_fetch_add_explicit(&sl->gen, 1, memory_order_release) + 1;
+    pool_unlock(sh);
+    ML_STAT_OBJECT(p->stat_type, 1, p->obj_size);
+    return ((ml_handle)gen << 32) | (((idx << POOL_SHARD_BITS) | shard) + 1);
+}
+
+static pool_slot *pool_slot_of(const ml_pool *p, ml_handle h) {
+    if (!h) return NULL;
+    uint32_t key = (uint32_t)h - 1;
+    const pool_shard *sh = &p->shards[key & (POOL_SHARDS - 1)];
+    uint32_t idx = key >> POOL_SHARD_BITS;
+    if (idx >= POOL_MAX_CHUNKS * POOL_CHUNK_SLOTS)
+        return NULL;
+    unsigned char *chunk = atomic_load_explicit(&sh->chunks[idx / POOL_CHUNK_SLOTS],
+                                                memory_order_acquire);
+    return chunk ? pool_slot_at(p, chunk, idx) : NULL;
+}
+
+static void *pool_get(const ml_pool *p, ml_handle h) {
+    pool_slot *sl = pool_slot_of(p, h);
+    if (!sl || atomic_load_explicit(&sl->gen, memory_order_acquire) != (uint32_t)(h >> 32))
+        return NULL;
+    return sl->obj;
+}
+
+static void pool_free(ml_pool *p, ml_handle h) {
+    pool_slot *sl = pool_slot_of(p, h);
+    if (!sl) return;
+    uint32_t key = (uint32_t)h - 1;
+    pool_shard *sh = &p->shards[key & (POOL_SHARDS - 1)];
+    pool_lock(sh);
+    if (atomic_load_explicit(&sl->gen, memory_order_relaxed) != (uint32_t)(h >> 32)) {
+        pool_unlock(sh);
+        return;
+    }
+    atomic_fetch_add_explicit(&sl->gen, 1, memory_order_release);
+    sl->next_free = sh->free_head;
+    sh->free_head = (key >> POOL_SHARD_BITS) + 1;
+    pool_unlock(sh);
+    ML_STAT_OBJECT(p->stat_type, -1, -(int64_t)p->obj_size);
+}
+#else
+// System-heap backend: a handle is the object address and is never checked,
+// so KLEE keeps seeing every allocation and every stale dereference.
+static ml_handle pool_alloc(ml_pool *p) {
+#ifdef KLEE_DRIVER_BUILD
+    // Site the chunk by its type so the leak oracle can tell objects apart.
+    ml_handle h = (ml_handle)(uintptr_t)shadow_calloc(1, p->obj_size, p->type_name, 0);
+#else
+    ml_handle h = (ml_handle)(uintptr_t)calloc(1, p->obj_size);
+#endif
+    if (h) ML_STAT_OBJECT(p->stat_type, 1, p->obj_size);
+    return h;
+}
+
+static void *pool_get(const ml_pool *p, ml_handle h) {
+    (void)p;
+    return (void *)(uintptr_t)h;
+}
+
+static void pool_free(ml_pool *p, ml_handle h) {
+    (void)p;
+    if (h) ML_STAT_OBJECT(p->stat_type, -1, -(int64_t)p->obj_size);
+    free((void *)(uintptr_t)h);
+}
+#endif
+
+avatar *avatar_get(ml_handle h) {
+    return pool_get(&avatar_pool, h);
+}
+
+start_loc *start_loc_get(ml_handle h) {
+    return pool_get(&start_loc_pool, h);
+}
+
+// ============================================================================
+// SESSION TABLE
+// ============================================================================
+#ifndef METALOGIN_SYSTEM_ALLOC
+// Sessions are spread round-robin over shards; each shard grows in chunks of
+// cache-line-aligned records that never move, so session_get needs no lock.
+#define SESSION_SHARD_BITS   4
+#define SESSION_SHARDS       (1u << SESSION_SHARD_BITS)
+#define SESSION_CHUNK_SLOTS  64
+#define SESSION_MAX_CHUNKS   1024
+
+typedef struct session_slot {
+    _Alignas(ML_CACHE_LINE) session s;
+    _Atomic uint32_t gen;       // odd while live
+    uint32_t  next_free;
+} session_slot;
+
+typedef struct session_shard {
+    _Alignas(ML_CACHE_LINE) atomic_int lock;
+    uint32_t  nslots;
+    uint32_t  free_head;        // slot index + 1, 0 when empty
+    session_slot *_Atomic chunks[SESSION_MAX_CHUNKS];
+} session_shard;
+
+static session_shard session_table[SESSION_SHARDS];
+static atomic_uint session_next_shard;
+
+static void shard_lock(session_shard *sh) {
+    while (atomic_exchange_explicit(&sh->lock, 1, memory_order_acquire))
+        ;
+}
+
+static void shard_unlock(session_shard *sh) {
+    atomic_store_explicit(&sh->lock, 0, memory_order_release);
+}
+
+static session_slot *session_chunk(session_shard *sh, uint32_t idx) {
+    return atomic_load_explicit(&sh->chunks[idx / SESSION_CHUNK_SLOTS], memory_order_acquire);
+}
+
+static session_slot *session_slot_at(session_shard *sh, uint32_t idx) {
+    return &session_chunk(sh, idx)[idx % SESSION_CHUNK_SLOTS];
+}
+
+static session_h session_alloc(void) {
+    uint32_t shard = atomic_fetch_add_explicit(&session_next_shard, 1, memory_order_relaxed)
+                     % SESSION_SHARDS;
+    session_shard *sh = &session_table[shard];
+    session_slot *sl;
+    uint32_t idx;
+
+    shard_lock(sh);
+    if (sh->free_head) {
+        idx = sh->free_head - 1;
+        sl = session_slot_at(sh, idx);
+        sh->free_head = sl->next_free;
+    } else {
+        if (sh->nslots == SESSION_MAX_CHUNKS * SESSION_CHUNK_SLOTS) {
+            shard_unlock(sh);
+            return ML_NULL_HANDLE;
+        }
+        if (sh->nslots % SESSION_CHUNK_SLOTS == 0) {
+            session_slot *chunk = aligned_alloc(ML_CACHE_LINE,
+                                                SESSION_CHUNK_SLOTS * sizeof(session_slot));
+            if (!chunk) {
+                shard_unlock(sh);
+                return ML_NULL_HANDLE;
+            }
+            memset(chunk, 0, SESSION_CHUNK_SLOTS * sizeof(session_slot));
+            atomic_store_explicit(&sh->chunks[sh->nslots / SESSION_CHUNK_SLOTS], chunk,
+                                  memory_order_release);
+        }
+        idx = sh->nslots++;
+        sl = session_slot_at(sh, idx);
+    }
+    memset(&sl->s, 0, sizeof(sl->s));
+    uint32_t gen = atomic_fetch_add_explicit(&sl->gen, 1, memory_order_release) + 1;
+    shard_unlock(sh);
+    return ((ml_handle)gen << 32) | (((idx << SESSION_SHARD_BITS) | shard) + 1);
+}
+
+session *session_get(session_h h) {
+    if (!h) return NULL;
+    uint32_t key = (uint32_t)h - 1;
+    session_shard *sh = &session_table[key & (SESSION_SHARDS - 1)];
+    uint32_t idx = key >> SESSION_SHARD_BITS;
+    if (idx >= SESSION_MAX_CHUNKS * SESSION_CHUNK_SLOTS || !session_chunk(sh, idx))
+        return NULL;
+    session_slot *sl = session_slot_at(sh, idx);
+    if (atomic_load_explicit(&sl->gen, memory_order_acquire) != (uint32_t)(h >> 32))
+        return NULL;
+    return &sl->s;
+}
+
+static void session_release(session_h h) {
+    uint32_t key = (uint32_t)h - 1;
+    session_shard *sh = &session_table[key & (SESSION_SHARDS - 1)];
+    uint32_t idx = key >> SESSION_SHARD_BITS;
+    shard_lock(sh);
+    session_slot *sl = session_slot_at(sh, idx);
+    atomic_fetch_add_explicit(&sl->gen, 1, memory_order_release);
+    sl->next_free = sh->free_head;
+    sh->free_head = idx + 1;
+    shard_unlock(sh);
+}
+#else
+static session_h session_alloc(void) {
+    return (session_h)(uintptr_t)calloc(1, sizeof(session));
+}
+
+session *session_get(session_h h) {
+    return (session *)(uintptr_t)h;
+}
+
+static void session_release(session_h h) {
+    free((void *)(uintptr_t)h);
+}
+#endif
+
+// Each session writes to its own stream (a connection's buffer in the socket
+// front end); NULL means stdout.
+static FILE *session_out(session_h sess) {
+    session *s = session_get(sess);
+    return s && s->out ? s->out : stdout;
+}
+
+// The avatar a session may still change or free. clear_avatar frees the
+// avatar but leaves current_avatar set (WMI-2). The pooled backend resolves
+// that stale handle to NULL; under METALOGIN_SYSTEM_ALLOC it is a raw
+// address, and freeing it again would corrupt the heap, so avatar_released
+// makes both backends agree. The render callbacks still read through it.
+static avatar *session_avatar(const session *s) {
+    return s->avatar_released ? NULL : avatar_get(s->current_avatar);
+}
+
+session_h session_open(void) {
+    session_h h = session_alloc();
+    session *s = session_get(h);
+    if (!s) return ML_NULL_HANDLE;
+    s->current_avatar = ML_NULL_HANDLE;
+    s->session_id = strdup("SESSION-4471");
+    ML_STAT_OBJECT(ML_STAT_SESSION, 1, sizeof(session));
+    ML_STAT_OBJECT(ML_STAT_STRING, 1, sizeof("SESSION-4471"));
+    s->is_active = 0;
+    s->is_blacksun_member = 0;
+    return h;
+}
+
+// ============================================================================
+// RENDER BUFFER
+// ============================================================================
+#define RENDER_BUF_MIN 1024
+
+// Box-drawing frames are built once as literals so a card is a handful of
+// memcpys rather than one stdio call per line or byte.
+#define ASCII_BOX_TOP \
+    "\n" \
+    "╔═══════════════════════════════════════════╗\n" \
+    "║     METAVERSE AVATAR (Standard)           ║\n" \
+    "╠═══════════════════════════════════════════╣\n" \
+    "║ Username: "
+#define ASCII_BOX_BOTTOM \
+    "║\n" \
+    "╚═══════════════════════════════════════════╝\n" \
+    "\n"
+#define HEX_BOX_TOP \
+    "\n" \
+    "╔═══════════════════════════════════════════════════╗\n" \
+    "║     METAVERSE AVATAR (Black Sun)                  ║\n" \
+    "╠═══════════════════════════════════════════════════╣\n" \
+    "║ LEET USER (can read hex):                         ║\n" \
+    "╠═══════════════════════════════════════════════════╣\n"
+#define HEX_BOX_RULE \
+    "╠═══════════════════════════════════════════════════╣\n"
+#define HEX_BOX_HEADED \
+    "║ Here's where you're headed:                       ║\n"
+#define HEX_BOX_BOTTOM \
+    "╚═══════════════════════════════════════════════════╝\n" \
+    "\n"
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+// Returns room for n more bytes, or NULL if the buffer cannot grow (the
+// output is then dropped rather than half-written).
+static char *rb_reserve(render_buf *rb, size_t n) {
+    if (rb->len + n > rb->cap) {
+        size_t cap = rb->cap ? rb->cap : RENDER_BUF_MIN;
+        while (rb->len + n > cap) cap *= 2;
+        char *p = realloc(rb->data, cap);
+        if (!p) return NULL;
+        ML_STAT_OBJECT(ML_STAT_RENDER, rb->cap == 0, cap - rb->cap);
+        rb->data = p;
+        rb->cap = cap;
+    }
+    return rb->data + rb->len;
+}
+
+static void rb_append(render_buf *rb, const char *src, size_t n) {
+    char *p = rb_reserve(rb, n);
+    if (!p) return;
+    memcpy(p, src, n);
+    rb->len += n;
+}
+
+#define rb_literal(rb, lit) rb_append((rb), (lit), sizeof(lit) - 1)
+
+static void rb_fill(render_buf *rb, char c, size_t n) {
+    char *p = rb_reserve(rb, n);
+    if (!p) return;
+    memset(p, c, n);
+    rb->len += n;
+}
+
+// Appends s left-justified in a field of width columns, like "%-*s".
+static void rb_padded(render_buf *rb, const char *s, size_t max, size_t width) {
+    size_t n = strnlen(s, max);
+    rb_append(rb, s, n);
+    if (n < width) rb_fill(rb, ' ', width - n);
+}
+
+static void rb_hex32(render_buf *rb, uint32_t v) {
+    char *p = rb_reserve(rb, 8);
+    if (!p) return;
+    for (int i = 7; i >= 0; i--, v >>= 4)
+        p[i] = hex_digits[v & 0xF];
+    rb->len += 8;
+}
+
+static void rb_long(render_buf *rb, long v) {
+    char tmp[24];
+    char *p = tmp + sizeof(tmp);
+    unsigned long u = v < 0 ? 0UL - (unsigned long)v : (unsigned long)v;
+    do {
+        *--p = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (v < 0) *--p = '-';
+    rb_append(rb, p, (size_t)(tmp + sizeof(tmp) - p));
+}
+
+// "║ XX XX XX XX XX XX XX XX | XX XX XX XX XX XX XX XX ║ \n"
+static void rb_hex16(render_buf *rb, const char *buf) {
+    const unsigned char *b = (const unsigned char *)buf;
+    rb_literal(rb, "║ ");
+    char *p = rb_reserve(rb, 16 * 3 + 2);
+    if (!p) return;
+    char *q = p;
+    for (int i = 0; i < 16; i++) {
+        *q++ = hex_digits[b[i] >> 4];
+        *q++ = hex_digits[b[i] & 0xF];
+        if (i == 7) {
+            memcpy(q, " | ", 3);
+            q += 3;
+        } else if (i != 15) {
+            *q++ = ' ';
+        }
+    }
+    rb->len += (size_t)(q - p);
+    rb_literal(rb, " ║ \n");
+}
+
+// Writes the buffered card with a single call and empties the buffer.
+static void rb_flush(session *s) {
+    render_buf *rb = &s->render;
+    if (!rb->len) return;
+    if (s->out) {
+        fwrite(rb->data, 1, rb->len, s->out);
+    } else {
+        fflush(stdout);     // keep order with earlier printf output
+        size_t off = 0;
+        while (off < rb->len) {
+            ssize_t n = write(STDOUT_FILENO, rb->data + off, rb->len - off);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            off += (size_t)n;
+        }
+    }
+    rb->len = 0;
+}
+
 // ============================================================================
 // INVENTORY MANAGEMENT
 // ============================================================================
-static item *item_create(const char *name, long inventory_obj) {
-    item *it = (item*)malloc(sizeof(*it));
-    if (!it) {
+static item inv_tombstone;
+#define INV_TOMBSTONE (&inv_tombstone)
+
+static size_t inv_hash(long inventory_obj, size_t cap) {
+    uint64_t h = (uint64_t)inventory_obj * 0x9E3779B97F4A7C15ull;
+    return (size_t)(h ^ (h >> 32)) & (cap - 1);
+}
+
+static inventory *inventory_create(void) {
+    inventory *inv = calloc(1, sizeof(*inv));
+    if (!inv) {
         printf("[ERROR] Memory allocation failed\n");
         exit(0);
     }
+    inv->refs = 1;
+    ML_STAT_OBJECT(ML_STAT_INVENTORY, 1, sizeof(*inv));
+    return inv;
+}
+
+// Returns the index slot holding inventory_obj, or NULL if it is not present.
+static item **inv_index_find(inventory *inv, long inventory_obj) {
+    if (!inv->index) return NULL;
+    size_t mask = inv->index_cap - 1;
+    for (size_t i = inv_hash(inventory_obj, inv->index_cap); ; i = (i + 1) & mask) {
+        item *it = inv->index[i];
+        if (!it) return NULL;
+        if (it != INV_TOMBSTONE && it->inventory_obj == inventory_obj)
+            return &inv->index[i];
+    }
+}
+
+static void inv_index_place(inventory *inv, item *it) {
+    size_t mask = inv->index_cap - 1;
+    size_t i = inv_hash(it->inventory_obj, inv->index_cap);
+    while (inv->index[i] && inv->index[i] != INV_TOMBSTONE)
+        i = (i + 1) & mask;
+    if (!inv->index[i]) inv->index_used++;
+    inv->index[i] = it;
+}
+
+// Rebuilds the index with room for at least `keys` live keys.
+static void inv_index_rehash(inventory *inv, size_t keys) {
+    size_t cap = inv->index_cap ? inv->index_cap : INVENTORY_INDEX_MIN;
+    while (keys * 2 >= cap) cap *= 2;
+    item **old = inv->index;
+    size_t old_cap = inv->index_cap;
+    inv->index = calloc(cap, sizeof(item *));
+    if (!inv->index) {
+        printf("[ERROR] Memory allocation failed\n");
+        exit(0);
+    }
+    ML_STAT_OBJECT(ML_STAT_INVENTORY, 0, (cap - old_cap) * sizeof(item *));
+    inv->index_cap = cap;
+    inv->index_used = 0;
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old[i] && old[i] != INV_TOMBSTONE)
+            inv_index_place(inv, old[i]);
+    }
+    free(old);
+}
+
+static void inv_index_insert(inventory *inv, item *it) {
+    item **slot = inv_index_find(inv, it->inventory_obj);
+    if (slot) {
+        it->older = *slot;
+        *slot = it;
+        return;
+    }
+    it->older = NULL;
+    if ((inv->index_used + 1) * 4 > inv->index_cap * 3)
+        inv_index_rehash(inv, inv->count);
+    inv_index_place(inv, it);
+}
+
+static item *item_alloc(inventory *inv) {
+    item *it = inv->free_list;
+    if (it) {
+        inv->free_list = it->next;
+        return it;
+    }
+    if (!inv->slabs || inv->slab_used == inv->slabs->nitems) {
+        size_t n = inv->slabs ? inv->slabs->nitems * 2 : INVENTORY_SLAB_MIN;
+        item_slab *sl = malloc(sizeof(*sl) + n * sizeof(item));
+        if (!sl) {
+            printf("[ERROR] Memory allocation failed\n");
+            exit(0);
+        }
+        sl->next = inv->slabs;
+        sl->nitems = n;
+        inv->slabs = sl;
+        inv->slab_used = 0;
+    }
+    return &inv->slabs->items[inv->slab_used++];
+}
+
+// Makes room for n more items with at most one slab allocation and one index
+// rebuild, instead of growing step by step as they arrive.
+static void inventory_reserve(inventory *inv, size_t n) {
+    size_t room = inv->slabs ? inv->slabs->nitems - inv->slab_used : 0;
+    if (room < n) {
+        size_t want = inv->slabs ? inv->slabs->nitems * 2 : INVENTORY_SLAB_MIN;
+        if (want < n) want = n;
+        item_slab *sl = malloc(sizeof(*sl) + want * sizeof(item));
+        if (!sl) {
+            printf("[ERROR] Memory allocation failed\n");
+            exit(0);
+        }
+        sl->next = inv->slabs;
+        sl->nitems = want;
+        inv->slabs = sl;
+        inv->slab_used = 0;
+    }
+    if ((inv->index_used + n + 1) * 4 > inv->index_cap * 3)
+        inv_index_rehash(inv, inv->count + n);
+}
+
+static item *item_create(inventory *inv, const char *name, long inventory_obj) {
+    item *it = item_alloc(inv);
     memset(it->thingname, 0, MAX_LENGTH);
     strncpy(it->thingname, name, MAX_LENGTH-1);
     it->inventory_obj = inventory_obj;
     it->next = NULL;
+    it->prev = NULL;
+    it->older = NULL;
+    ML_STAT_OBJECT(ML_STAT_ITEM, 1, sizeof(item));
     return it;
 }
 
-static void item_free(item *it) {
+static void item_free(inventory *inv, item *it) {
     if (!it) return;
-    free(it);
+    it->next = inv->free_list;
+    inv->free_list = it;
+    ML_STAT_OBJECT(ML_STAT_ITEM, -1, -(int64_t)sizeof(item));
+}
+
+// ---------- snapshot base ----------
+// Index entries and older links come from the file and are bounds-checked on
+// use, so restoring never has to walk the records.
+static int base_is_removed(const inventory *inv, size_t rec) {
+    return inv->base_removed && ((inv->base_removed[rec >> 3] >> (rec & 7)) & 1);
+}
+
+// Returns the newest live base record for inventory_obj, or -1.
+static long base_find(const inventory *inv, long inventory_obj) {
+    size_t mask = inv->base_index_cap - 1;
+    size_t i = inv_hash(inventory_obj, inv->base_index_cap);
+    for (size_t probes = 0; probes <= mask; probes++, i = (i + 1) & mask) {
+        uint32_t e = inv->base_index[i];
+        if (!e || e > inv->base_count) return -1;
+        if (inv->base[e - 1].inventory_obj != inventory_obj) continue;
+        for (size_t hops = 0; e && e <= inv->base_count && hops < inv->base_count; hops++) {
+            if (!base_is_removed(inv, e - 1)) return (long)e - 1;
+            e = inv->base[e - 1].older;
+        }
+        return -1;
+    }
+    return -1;
+}
+
+static int base_remove(inventory *inv, long inventory_obj) {
+    long rec = base_find(inv, inventory_obj);
+    if (rec < 0) return 0;
+    if (!inv->base_removed) {
+        inv->base_removed = calloc((inv->base_count + 7) / 8, 1);
+        if (!inv->base_removed) {
+            printf("[ERROR] Memory allocation failed\n");
+            exit(0);
+        }
+    }
+    inv->base_removed[rec >> 3] |= (uint8_t)(1u << (rec & 7));
+    inv->base_live--;
+    return 1;
+}
+
+static void snap_map_release(snap_map *m) {
+    if (m && atomic_fetch_sub(&m->refs, 1) == 1) {
+        munmap((void *)m->data, m->len);
+        free(m);
+    }
+}
+
+// Walks an inventory newest first: heap items, then live snapshot records.
+typedef struct inv_iter {
+    const item *next_item;
+    size_t     next_rec;
+} inv_iter;
+
+static void inv_iter_init(const inventory *inv, inv_iter *it) {
+    it->next_item = inv ? inv->head : NULL;
+    it->next_rec = 0;
 }
 
-int items_add(item **headp, const char *name, long inventory_obj) {
-    if (!headp) return -EINVAL;
-    item *it = item_create(name, inventory_obj);
-    if (!it) return -ENOMEM;
-    it->next = *headp;
-    *headp = it;
+static int inv_iter_next(const inventory *inv, inv_iter *it, long *obj, const char **name) {
+    if (it->next_item) {
+        *obj = it->next_item->inventory_obj;
+        *name = it->next_item->thingname;
+        it->next_item = it->next_item->next;
+        return 1;
+    }
+    while (inv && it->next_rec < inv->base_count) {
+        size_t r = it->next_rec++;
+        if (base_is_removed(inv, r)) continue;
+        *obj = (long)inv->base[r].inventory_obj;
+        *name = inv->base[r].thingname;
+        return 1;
+    }
     return 0;
 }
 
-int items_remove_by_obj(item **headp, long inventory_obj) {
-    if (!headp) return -EINVAL;
-    item *prev = NULL, *cur = *headp;
-    while (cur) {
-        if (cur->inventory_obj == inventory_obj) {
-            if (prev) prev->next = cur->next;
-            else *headp = cur->next;
-            item_free(cur);
-            return 1;
+static size_t inv_size(const inventory *inv) {
+    return inv ? inv->count + inv->base_live : 0;
+}
+
+static void inv_push(inventory *inv, const char *name, long inventory_obj) {
+    item *it = item_create(inv, name, inventory_obj);
+    it->next = inv->head;
+    if (inv->head) inv->head->prev = it;
+    inv->head = it;
+    if (!inv->tail) inv->tail = it;
+    inv->count++;
+    inv_index_insert(inv, it);
+}
+
+// ---------- sharing ----------
+static inventory *inventory_share(inventory *inv) {
+    if (inv) inv->refs++;
+    return inv;
+}
+
+// Returns *invp ready to be modified: created if missing, and replaced by a
+// private copy while another owner still shares it.
+static inventory *inventory_writable(inventory **invp) {
+    inventory *inv = *invp;
+    if (!inv) return *invp = inventory_create();
+    if (inv->refs == 1) return inv;
+
+    inventory *copy = inventory_create();
+    if (inv->base) {
+        copy->base_map = inv->base_map;
+        copy->base = inv->base;
+        copy->base_index = inv->base_index;
+        copy->base_count = inv->base_count;
+        copy->base_index_cap = inv->base_index_cap;
+        copy->base_live = inv->base_live;
+        atomic_fetch_add(&copy->base_map->refs, 1);
+        if (inv->base_removed) {
+            size_t bytes = (inv->base_count + 7) / 8;
+            copy->base_removed = malloc(bytes);
+            if (!copy->base_removed) {
+                printf("[ERROR] Memory allocation failed\n");
+                exit(0);
+            }
+            memcpy(copy->base_removed, inv->base_removed, bytes);
         }
-        prev = cur;
-        cur = cur->next;
     }
+    // Oldest first, so duplicates chain up in the same order.
+    if (inv->count) inventory_reserve(copy, inv->count);
+    for (const item *it = inv->tail; it; it = it->prev)
+        inv_push(copy, it->thingname, it->inventory_obj);
+    inv->refs--;
+    return *invp = copy;
+}
+
+int items_add(inventory **invp, const char *name, long inventory_obj) {
+    if (!invp) return -EINVAL;
+    inv_push(inventory_writable(invp), name, inventory_obj);
     return 0;
 }
 
-void items_clear_all(item **headp) {
-    if (!headp) return;
-    item *cur = *headp;
-    while (cur) {
-        item *next = cur->next;
-        item_free(cur);
-        cur = next;
+int items_remove_by_obj(inventory **invp, long inventory_obj) {
+    if (!invp) return -EINVAL;
+    inventory *inv = *invp;
+    if (!inv) return 0;
+    if (inv->refs > 1) {
+        if (!inv_index_find(inv, inventory_obj) && (!inv->base || base_find(inv, inventory_obj) < 0))
+            return 0;
+        inv = inventory_writable(invp);
+    }
+    item **slot = inv_index_find(inv, inventory_obj);
+    if (!slot) return inv->base ? base_remove(inv, inventory_obj) : 0;
+    item *cur = *slot;
+    *slot = cur->older ? cur->older : INV_TOMBSTONE;
+    if (cur->prev) cur->prev->next = cur->next;
+    else inv->head = cur->next;
+    if (cur->next) cur->next->prev = cur->prev;
+    else inv->tail = cur->prev;
+    inv->count--;
+    item_free(inv, cur);
+    return 1;
+}
+
+// Drops this owner's reference; the last owner frees the items.
+void items_clear_all(inventory **invp) {
+    if (!invp || !*invp) return;
+    inventory *inv = *invp;
+    *invp = NULL;
+    if (--inv->refs) return;
+    ML_STAT_OBJECT(ML_STAT_ITEM, -(int64_t)inv->count, -(int64_t)(inv->count * sizeof(item)));
+    ML_STAT_OBJECT(ML_STAT_INVENTORY, -1,
+                   -(int64_t)(sizeof(*inv) + inv->index_cap * sizeof(item *)));
+    item_slab *sl = inv->slabs;
+    while (sl) {
+        item_slab *next = sl->next;
+        free(sl);
+        sl = next;
     }
-    *headp = NULL;
+    free(inv->index);
+    free(inv->base_removed);
+    snap_map_release(inv->base_map);
+    free(inv);
 }
 
 /* ---------- inventory wrappers ---------- */
-static item **inventory_headp(void) {
-    return g_session.is_active ? (item **)&g_session.current_avatar->inventory : (item **)&g_session.inventory;
+// A logged-in avatar uses its own inventory; a guest, or a session whose
+// avatar has logged out, uses the guest inventory.
+static inventory **inventory_slot(session *s) {
+    avatar *av = s->is_active ? session_avatar(s) : NULL;
+    return av ? &av->inventory : &s->inventory;
 }
 
-int inventory_add(const char *name, long inventory_obj) {
-    item **headp = inventory_headp();
-    if (!headp) return -EINVAL;
-    return items_add(headp, name, inventory_obj);
+int inventory_add(session_h sess, const char *name, long inventory_obj) {
+    session *s = session_get(sess);
+    if (!s) return -EINVAL;
+    inventory **invp = inventory_slot(s);
+    if (!invp) return -EINVAL;
+    int rc = items_add(invp, name, inventory_obj);
+    if (rc == 0) ML_JOURNAL(sess, JOURNAL_ITEM_ADD, 0, inventory_obj, name);
+    return rc;
 }
 
-int inventory_remove_by_obj(long inventory_obj) {
-    item **headp = inventory_headp();
-    if (!headp) return -EINVAL;
-    return items_remove_by_obj(headp, inventory_obj);
+int inventory_remove_by_obj(session_h sess, long inventory_obj) {
+    session *s = session_get(sess);
+    if (!s) return -EINVAL;
+    inventory **invp = inventory_slot(s);
+    if (!invp) return -EINVAL;
+    int rc = items_remove_by_obj(invp, inventory_obj);
+    ML_JOURNAL(sess, JOURNAL_ITEM_REMOVE, rc, inventory_obj, NULL);
+    return rc;
 }
 
 /* ---------- top level inventory calls ---------- */
-void add_item_from_user(void) {
+void add_item_from_user(session_h sess) {
+    FILE *out = session_out(sess);
     char name[16];
     long  num;
 
-    printf("Enter item name (max 15 chars): ");
+    fprintf(out, "Enter item name (max 15 chars): ");
     if (!fgets(name, sizeof(name), stdin))
         return;
     name[strcspn(name, "\n")] = '\0';
 
-    printf("Enter item number: ");
+    fprintf(out, "Enter item number: ");
     if (scanf("%ld", &num) != 1) {
-        printf("[ERROR] Invalid number.\n");
+        fprintf(out, "[ERROR] Invalid number.\n");
         while (getchar() != '\n');
         return;
     }
     while (getchar() != '\n');
 
-    if (inventory_add(name, num) == 0)
-        printf("[SYSTEM] Item added.\n");
+    if (inventory_add(sess, name, num) == 0)
+        fprintf(out, "[SYSTEM] Item added.\n");
     else
-        printf("[ERROR] Failed to add item.\n");
+        fprintf(out, "[ERROR] Failed to add item.\n");
 }
 
-void remove_item_from_user(void) {
+void remove_item_from_user(session_h sess) {
+    FILE *out = session_out(sess);
     int num;
 
-    printf("Enter item number to remove: ");
+    fprintf(out, "Enter item number to remove: ");
     if (scanf("%d", &num) != 1) {
-        printf("Invalid number.\n");
+        fprintf(out, "Invalid number.\n");
         while (getchar() != '\n');
         return;
     }
     while (getchar() != '\n');
 
-    int result = inventory_remove_by_obj(num);
+    int result = inventory_remove_by_obj(sess, num);
     if (result > 0)
-        printf("[SYSTEM] Item removed.\n");
+        fprintf(out, "[SYSTEM] Item removed.\n");
     else if (result == 0)
-        printf("[ERROR] Item not found.\n");
+        fprintf(out, "[ERROR] Item not found.\n");
     else
-        printf("[ERROR] Error removing item.\n");
+        fprintf(out, "[ERROR] Error removing item.\n");
 }
 
-void inventory_clear_all(void) {
-    if (!g_session.current_avatar)
+void inventory_clear_all(session_h sess) {
+    session *s = session_get(sess);
+    if (!s) return;
+    avatar *av = session_avatar(s);
+    if (!av)
         return;
-    if (g_session.current_avatar->inventory)
-        items_clear_all(g_session.current_avatar->inventory);
+    if (av->inventory)
+        items_clear_all(&av->inventory);
+    ML_JOURNAL(sess, JOURNAL_ITEM_CLEAR, 0, 0, NULL);
 }
 
-void view_inventory(void) {
-    item *cur = NULL;
-    if (g_session.is_active)
-        cur = g_session.current_avatar->inventory;
-    else
-        cur = g_session.inventory;
-    if (!cur) {
-        printf("[SYSTEM] Inventory is empty.\n");
+void view_inventory(session_h sess) {
+    session *s = session_get(sess);
+    if (!s) return;
+    FILE *out = session_out(sess);
+    inventory *inv = *inventory_slot(s);
+    if (!inv_size(inv)) {
+        fprintf(out, "[SYSTEM] Inventory is empty.\n");
         return;
     }
-    printf("=== Current Inventory ===\n");
-    while (cur) {
-        printf("Name: %-15s | ID: %ld\n",
-               cur->thingname ? cur->thingname : "(null)",
-               cur->inventory_obj);
-        cur = cur->next;
+    render_buf *rb = &s->render;
+    rb_literal(rb, "=== Current Inventory ===\n");
+    inv_iter it;
+    long obj;
+    const char *name;
+    inv_iter_init(inv, &it);
+    while (inv_iter_next(inv, &it, &obj, &name)) {
+        rb_literal(rb, "Name: ");
+        rb_padded(rb, name, MAX_LENGTH, 15);
+        rb_literal(rb, " | ID: ");
+        rb_long(rb, obj);
+        rb_literal(rb, "\n");
     }
+    rb_flush(s);
 }
 
 // ============================================================================
 // START LOCATION MANAGEMENT
 // ============================================================================
-static void be_store_u32(uint8_t out[4], uint32_t v) {
-    out[0] = (uint8_t)((v >> 24) & 0xFF);
-    out[1] = (uint8_t)((v >> 16) & 0xFF);
-    out[2] = (uint8_t)((v >>  8) & 0xFF);
-    out[3] = (uint8_t)( v        & 0xFF);
-}
-
+#ifndef KLEE_DRIVER_BUILD
 static int parse_u8_strict(const char *s, uint8_t *out_val) {
     if (!s || !*s) return 0;
     char *end = NULL;
@@ -174,73 +932,107 @@ static int parse_u8_strict(const char *s, uint8_t *out_val) {
     *out_val = (uint8_t)v;
     return 1;
 }
+#else
+// KLEE summary of the above over the stubs' strtol (decimal digits only):
+// one or more digits up to the NUL, at most 255. s is a MAX_LENGTH buffer
+// holding a NUL. Value and validity are folded over the whole buffer without
+// branching, so a symbolic name costs the caller one constraint rather than
+// a fork per digit.
+static int parse_u8_strict(const char *s, uint8_t *out_val) {
+    if (!s) return 0;
+    uint64_t v = 0;
+    unsigned live = 1, ok = 1, digits = 0;
+    for (size_t i = 0; i < MAX_LENGTH; i++) {
+        unsigned c = (unsigned char)s[i];
+        unsigned digit = c - '0' < 10u;
+        live &= c != 0;
+        ok &= (!live) | digit;
+        digits += live;
+        v = v * (1 + 9 * live) + (uint64_t)((c - '0') & -live);
+    }
+    *out_val = (uint8_t)v;
+    return ok & (digits != 0) & (v <= 255);
+}
+#endif
 
-void set_start_location(void) {
-    char user_input[MAX_LENGTH];
-    if (g_session.start_loc != NULL) {
-        printf("[ERROR] Start Location already set - clear it first\n");
+void set_start_location_name(session_h sess, const char *user_input) {
+    session *s = session_get(sess);
+    if (!s) return;
+    FILE *out = session_out(sess);
+    if (s->start_loc != ML_NULL_HANDLE) {
+        fprintf(out, "[ERROR] Start Location already set - clear it first\n");
         return;
     }
 
-    printf("Enter Start Location Name: ");
-    if (fgets(user_input, sizeof(user_input), stdin)) {
-        user_input[strcspn(user_input, "\n")] = '\0';
-    }
     size_t len = strnlen(user_input, MAX_LENGTH-1);
     if (!len){
-        printf("[ERROR] You didn't enter anything\n");
-        return;
-    }
-    g_session.start_loc = malloc(sizeof(start_loc));
-    if (!g_session.start_loc) {
-        printf("[ERROR] Memory allocation failed\n");
+        fprintf(out, "[ERROR] You didn't enter anything\n");
         return;
     }
-    g_session.start_loc->location_name = malloc(len + 1);
-    if (!g_session.start_loc->location_name) {
-        printf("[ERROR] Memory allocation failed\n");
-        free(g_session.start_loc);
-        g_session.start_loc = NULL;
+    s->start_loc = pool_alloc(&start_loc_pool);
+    start_loc *sl = start_loc_get(s->start_loc);
+    if (!sl) {
+        fprintf(out, "[ERROR] Memory allocation failed\n");
+        s->start_loc = ML_NULL_HANDLE;
         return;
     }
-    memcpy(g_session.start_loc->location_name, user_input, len + 1);
 
-    // If user_input is an integer 0..255, place on the Street ring
+    memcpy(sl->custom_name, user_input, len);
+    sl->custom_name[len] = '\0';
+    sl->location_name = sl->custom_name;    // shown as typed, e.g. "007"
+
+    // If the name is an integer 0..255, place on the Street ring
     uint8_t port_idx;
-    if (parse_u8_strict(user_input, &port_idx)) {
-        const double C = 65536.0;
-        const double R = C / (2.0 * M_PI);
-        const double theta = (2.0 * M_PI) * ((double)port_idx / 256.0);
-        const double xd = R * cos(theta);
-        const double yd = R * sin(theta);
-        const double SCALE = 65536.0;
-        int32_t fx = (int32_t)llround(xd * SCALE);
-        int32_t fy = (int32_t)llround(yd * SCALE);
-        uint32_t ux = (uint32_t)((uint32_t)fx + 0x80000000u);
-        uint32_t uy = (uint32_t)((uint32_t)fy + 0x80000000u);
-        be_store_u32(&g_session.start_loc->coordinates[0], ux);
-        be_store_u32(&g_session.start_loc->coordinates[4], uy);
-        g_session.is_port = 1;
+    if (parse_u8_strict(sl->custom_name, &port_idx)) {
+        sl->coordinates = port_catalog[port_idx].coordinates;
+        s->is_port = 1;
     } else {
-        g_session.is_port = 0;
-        memset(g_session.start_loc->coordinates, 0, sizeof(g_session.start_loc->coordinates));
+        sl->coordinates = NULL;
+        s->is_port = 0;
+    }
+    ML_JOURNAL(sess, JOURNAL_START_LOC, 0, 0, sl->location_name);
+}
+
+void set_start_location(session_h sess) {
+    session *s = session_get(sess);
+    if (!s) return;
+    FILE *out = session_out(sess);
+    char user_input[MAX_LENGTH];
+    if (s->start_loc != ML_NULL_HANDLE) {
+        fprintf(out, "[ERROR] Start Location already set - clear it first\n");
+        return;
+    }
+
+    fprintf(out, "Enter Start Location Name: ");
+    if (fgets(user_input, sizeof(user_input), stdin)) {
+        user_input[strcspn(user_input, "\n")] = '\0';
     }
+    set_start_location_name(sess, user_input);
 }
 
-void clear_start_location(void) {
-    if (!g_session.start_loc) {
-        printf("[ERROR] No start_loc to clear\n");
+void clear_start_location(session_h sess) {
+    session *s = session_get(sess);
+    if (!s) return;
+    FILE *out = session_out(sess);
+    if (!s->start_loc) {
+        fprintf(out, "[ERROR] No start_loc to clear\n");
         return;
     }
-    g_session.is_port = 0;
-    free(g_session.start_loc);
-    g_session.start_loc = NULL;
+    s->is_port = 0;
+    pool_free(&start_loc_pool, s->start_loc);
+    s->start_loc = ML_NULL_HANDLE;
+    ML_JOURNAL(sess, JOURNAL_START_LOC_CLEAR, 0, 0, NULL);
 }
 
 // ============================================================================
 // AVATAR MANAGEMENT
 // ============================================================================
 int verify_black_sun_member(const char *username, const char *access_code) {
+#ifndef KLEE_DRIVER_BUILD
+    return blacksun_verify(username, access_code);
+#else
+    // KLEE keeps the linear scan: hashing a symbolic username would turn the
+    // directory lookup into a symbolic table index.
     for (int i = 0; i < NUM_BLACK_SUN_MEMBERS; i++) {
         if (strcmp(username, black_sun_member_usernames[i]) == 0) {
             if (strcmp(access_code, black_sun_member_access_codes[i]) == 0) {
@@ -251,165 +1043,445 @@ int verify_black_sun_member(const char *username, const char *access_code) {
         }
     }
     return 0;
+#endif
 }
 
-void free_avatar_and_components(avatar *av) {
+void free_avatar_and_components(ml_handle h) {
+    avatar *av = avatar_get(h);
     if (!av) return;
-    if (av->access_code)
-        free(av->access_code);
-    if (av->username)
-        free(av->username);
-    inventory_clear_all();
-    av->inventory = NULL;
-    free(av);
+    items_clear_all(&av->inventory);
+    pool_free(&avatar_pool, h);
 }
 
-void set_avatar(char *username, char *access_code) {
-    if (g_session.is_active == 0x1337) {
-        g_session.is_blacksun_member = 0;
-        clear_avatar();
+void set_avatar(session_h sess, char *username, char *access_code) {
+    session *s = session_get(sess);
+    if (!s) return;
+    FILE *out = session_out(sess);
+    if (s->is_active == 0x1337) {
+        s->is_blacksun_member = 0;
+        clear_avatar(sess);
     }
 
-    avatar *av = malloc(sizeof(avatar));
+    ml_handle h = pool_alloc(&avatar_pool);
+    avatar *av = avatar_get(h);
     if (!av) {
-        printf("[ERROR] Memory allocation failed\n");
+        fprintf(out, "[ERROR] Memory allocation failed\n");
         exit(0);
     }
 
-    if (username) {
-        av->username = malloc(MAX_LENGTH);
-        if (!av->username) {
-            free_avatar_and_components(av);
-            printf("[ERROR] Memory allocation failed\n");
-            exit(0);
-        }
-        memset(av->username, 0, MAX_LENGTH);
+    memset(av->username, 0, MAX_LENGTH);
+    if (username)
         strncpy(av->username, username, MAX_LENGTH-1);
-    }
 
-    if (access_code) {
-        av->access_code = malloc(MAX_LENGTH);
-        if (!av->access_code) {
-            free_avatar_and_components(av);
-            printf("[ERROR] Memory allocation failed\n");
-            exit(0);
-        }
-        memset(av->access_code, 0, MAX_LENGTH);
+    memset(av->access_code, 0, MAX_LENGTH);
+    if (access_code)
         strncpy(av->access_code, access_code, MAX_LENGTH-1);
-    }
 
     int status = verify_black_sun_member(username, access_code);
+    ML_JOURNAL(sess, JOURNAL_LOGIN, status, 0, av->username);
     if (status == -1) {
-        printf("[ACCESS DENIED] Incorrect access code for Black Sun member\n");
-        free_avatar_and_components(av);
+        fprintf(out, "[ACCESS DENIED] Incorrect access code for Black Sun member\n");
+        free_avatar_and_components(h);
         return;
     } else if (status == 1) {
-        printf("[ACCESS GRANTED] Black Sun member verified\n");
-        g_session.is_blacksun_member = 0x1337;
+        fprintf(out, "[ACCESS GRANTED] Black Sun member verified\n");
+        s->is_blacksun_member = 0x1337;
     } else {
-        printf("[SYSTEM] Welcome User - %s\n", username);
+        fprintf(out, "[SYSTEM] Welcome User - %s\n", username);
     }
 
-    if (g_session.inventory)
-        av->inventory = g_session.inventory;
-    else
-        av->inventory = NULL;
+    // The avatar starts out sharing the guest inventory; whichever side
+    // changes it first gets its own copy.
+    av->inventory = inventory_share(s->inventory);
 
-    g_session.current_avatar = av;
-    g_session.is_active = 0x1337;
+    s->current_avatar = h;
+    s->avatar_released = 0;
+    s->is_active = 0x1337;
 
-    printf("[SYSTEM] Avatar '%s' loaded successfully\n", username);
+    fprintf(out, "[SYSTEM] Avatar '%s' loaded successfully\n", username);
 }
 
-void clear_avatar(void) {
-    if (g_session.is_active == 0) {
-        printf("[SYSTEM] No avatar currently set\n");
+void clear_avatar(session_h sess) {
+    session *s = session_get(sess);
+    if (!s) return;
+    FILE *out = session_out(sess);
+    if (s->is_active == 0) {
+        fprintf(out, "[SYSTEM] No avatar currently set\n");
         return;
     }
-    avatar *av = g_session.current_avatar;
+    avatar *av = session_avatar(s);
     if (!av) {
-        printf("[SYSTEM] No avatar currently set\n");
+        fprintf(out, "[SYSTEM] No avatar currently set\n");
         return;
     }
-    printf("\n[SYSTEM] Removing avatar '%s'\n", av->username);
-    free_avatar_and_components(av);
-    clear_start_location();
+    fprintf(out, "\n[SYSTEM] Removing avatar '%s'\n", av->username);
+    ML_JOURNAL(sess, JOURNAL_LOGOUT, 0, 0, av->username);
+    free_avatar_and_components(s->current_avatar);
+    s->avatar_released = 1;
+    clear_start_location(sess);
+}
+
+void session_close(session_h sess) {
+    session *s = session_get(sess);
+    if (!s) return;
+    if (s->start_loc)
+        clear_start_location(sess);
+    avatar *av = session_avatar(s);
+    if (av) {
+        items_clear_all(&av->inventory);
+        pool_free(&avatar_pool, s->current_avatar);
+    }
+    items_clear_all(&s->inventory);
+    ML_STAT_OBJECT(ML_STAT_STRING, -1, -(int64_t)(strlen(s->session_id) + 1));
+    ML_STAT_OBJECT(ML_STAT_RENDER, -(s->render.cap != 0), -(int64_t)s->render.cap);
+    ML_STAT_OBJECT(ML_STAT_SESSION, -1, -(int64_t)sizeof(session));
+    free(s->session_id);
+    free(s->render.data);
+    session_release(sess);
+}
+
+// ============================================================================
+// SNAPSHOTS
+// ============================================================================
+// snapshot_save streams sessions into "<path>.tmp" section by section and
+// renames it over path once complete. snapshot_load maps the file and hands
+// each restored inventory the mapped records directly, so restoring costs
+// the same whatever the inventory sizes.
+static int snap_pad(FILE *f) {
+    static const char zeros[8];
+    long off = ftell(f);
+    if (off < 0) return -1;
+    size_t pad = (size_t)(-off & 7);
+    return pad && fwrite(zeros, 1, pad, f) != pad ? -1 : 0;
+}
+
+// Writes one inventory's items, index and trailer; *off receives the
+// trailer's offset.
+static int snap_write_inventory(FILE *f, const inventory *inv, uint64_t *off) {
+    size_t n = inv_size(inv);
+    *off = 0;
+    if (!n) return 0;
+    if (n >= UINT32_MAX / 2) return -EOVERFLOW;
+    size_t cap = INVENTORY_INDEX_MIN;
+    while (cap < n * 2) cap *= 2;
+
+    // Pass 1: newest record per key, and each record's next older duplicate.
+    uint32_t *index = calloc(cap, sizeof(*index));
+    uint32_t *tail = calloc(cap, sizeof(*tail));
+    uint32_t *older = calloc(n, sizeof(*older));
+    long *objs = malloc(n * sizeof(*objs));
+    int rc = -ENOMEM;
+    if (!index || !tail || !older || !objs) goto out;
+
+    inv_iter it;
+    long obj;
+    const char *name;
+    size_t r = 0;
+    inv_iter_init(inv, &it);
+    while (r < n && inv_iter_next(inv, &it, &obj, &name)) {
+        objs[r] = obj;
+        size_t i = inv_hash(obj, cap);
+        while (index[i] && objs[index[i] - 1] != obj)
+            i = (i + 1) & (cap - 1);
+        if (index[i])
+            older[tail[i] - 1] = (uint32_t)r + 1;
+        else
+            index[i] = (uint32_t)r + 1;
+        tail[i] = (uint32_t)r + 1;
+        r++;
+    }
+
+    // Pass 2: records in list order, then the index and the trailer.
+    rc = -EIO;
+    if (snap_pad(f) < 0) goto out;
+    snap_inventory si = { .count = n, .index_cap = cap, .items_off = (uint64_t)ftell(f) };
+    inv_iter_init(inv, &it);
+    for (r = 0; r < n && inv_iter_next(inv, &it, &obj, &name); r++) {
+        snap_item rec = { .inventory_obj = obj, .older = older[r] };
+        strncpy(rec.thingname, name, MAX_LENGTH-1);
+        if (fwrite(&rec, sizeof(rec), 1, f) != 1) goto out;
+    }
+    si.index_off = (uint64_t)ftell(f);
+    if (fwrite(index, sizeof(*index), cap, f) != cap || snap_pad(f) < 0) goto out;
+    *off = (uint64_t)ftell(f);
+    if (fwrite(&si, sizeof(si), 1, f) != 1) goto out;
+    rc = 0;
+out:
+    free(index);
+    free(tail);
+    free(older);
+    free(objs);
+    return rc;
+}
+
+int snapshot_save(const char *path, const session_h *sessions, size_t n) {
+    size_t plen = strlen(path);
+    char *tmp = malloc(plen + 5);
+    uint64_t *inv_offs = calloc(n ? 2 * n : 1, sizeof(*inv_offs));
+    FILE *f = NULL;
+    int rc = -ENOMEM;
+    if (!tmp || !inv_offs) goto out;
+    memcpy(tmp, path, plen);
+    memcpy(tmp + plen, ".tmp", 5);
+    f = fopen(tmp, "wb");
+    if (!f) {
+        rc = -errno;
+        goto out;
+    }
+    setvbuf(f, NULL, _IOFBF, 1 << 16);
+
+    snap_header hdr = { .version = SNAP_VERSION, .endian = SNAP_ENDIAN };
+    memcpy(hdr.magic, SNAP_MAGIC, sizeof(hdr.magic));
+    rc = -EIO;
+    if (fwrite(&hdr, sizeof(hdr), 1, f) != 1) goto out;
+
+    // inv_offs[2i] is session i's guest inventory, inv_offs[2i+1] its avatar's.
+    for (size_t i = 0; i < n; i++) {
+        session *s = session_get(sessions[i]);
+        if (!s) continue;
+        rc = snap_write_inventory(f, s->inventory, &inv_offs[2 * i]);
+        if (rc < 0) goto out;
+        avatar *av = s->is_active ? session_avatar(s) : NULL;
+        if (!av) continue;
+        if (av->inventory && av->inventory == s->inventory) {
+            inv_offs[2 * i + 1] = inv_offs[2 * i];
+            continue;
+        }
+        rc = snap_write_inventory(f, av->inventory, &inv_offs[2 * i + 1]);
+        if (rc < 0) goto out;
+    }
+
+    rc = -EIO;
+    if (snap_pad(f) < 0) goto out;
+    hdr.sessions_off = (uint64_t)ftell(f);
+    for (size_t i = 0; i < n; i++) {
+        session *s = session_get(sessions[i]);
+        if (!s) continue;
+        snap_session ss = { .guest_inventory_off = inv_offs[2 * i],
+                            .avatar_inventory_off = inv_offs[2 * i + 1] };
+        avatar *av = s->is_active ? session_avatar(s) : NULL;
+        if (av) {
+            ss.flags |= SNAP_HAS_AVATAR;
+            memcpy(ss.username, av->username, MAX_LENGTH-1);
+            memcpy(ss.access_code, av->access_code, MAX_LENGTH-1);
+        }
+        start_loc *sl = start_loc_get(s->start_loc);
+        if (s->start_loc && sl) {
+            ss.flags |= SNAP_HAS_START_LOC;
+            strncpy(ss.start_loc, sl->location_name, MAX_LENGTH-1);
+        }
+        if (fwrite(&ss, sizeof(ss), 1, f) != 1) goto out;
+        hdr.nsessions++;
+    }
+    hdr.file_size = (uint64_t)ftell(f);
+    if (fseek(f, 0, SEEK_SET) != 0 || fwrite(&hdr, sizeof(hdr), 1, f) != 1) goto out;
+    if (fflush(f) != 0 || fsync(fileno(f)) != 0) goto out;
+    if (fclose(f) != 0) {
+        f = NULL;
+        goto out;
+    }
+    f = NULL;
+    rc = rename(tmp, path) == 0 ? 0 : -errno;
+out:
+    if (f) fclose(f);
+    if (rc < 0 && tmp) unlink(tmp);
+    free(tmp);
+    free(inv_offs);
+    return rc;
+}
+
+// Returns the mapped object at off if [off, off + size) lies in the file.
+static const void *snap_at(const snap_map *m, uint64_t off, uint64_t count, size_t size) {
+    if (off % 8 || off > m->len || count > (m->len - off) / size) return NULL;
+    return m->data + off;
+}
+
+// Restores the inventory whose trailer is at off (NULL for 0) into *out.
+static int snap_restore_inventory(snap_map *m, uint64_t off, inventory **out) {
+    *out = NULL;
+    if (!off) return 0;
+    const snap_inventory *si = snap_at(m, off, 1, sizeof(*si));
+    if (!si || si->count >= UINT32_MAX || !si->index_cap ||
+        (si->index_cap & (si->index_cap - 1)))
+        return -EINVAL;
+    const snap_item *base = snap_at(m, si->items_off, si->count, sizeof(snap_item));
+    const uint32_t *index = snap_at(m, si->index_off, si->index_cap, sizeof(uint32_t));
+    if (!base || !index)
+        return -EINVAL;
+    inventory *inv = inventory_create();
+    inv->base_map = m;
+    inv->base = base;
+    inv->base_index = index;
+    inv->base_count = si->count;
+    inv->base_index_cap = si->index_cap;
+    inv->base_live = si->count;
+    atomic_fetch_add(&m->refs, 1);
+    *out = inv;
+    return 0;
+}
+
+static int snap_restore_session(snap_map *m, const snap_session *ss, session_h *out) {
+    int has_avatar = (ss->flags & SNAP_HAS_AVATAR) != 0;
+    if (!has_avatar && ss->avatar_inventory_off)
+        return -EINVAL;
+    inventory *guest = NULL, *own = NULL;
+    int rc = snap_restore_inventory(m, ss->guest_inventory_off, &guest);
+    if (rc < 0) return rc;
+    if (ss->avatar_inventory_off && ss->avatar_inventory_off == ss->guest_inventory_off)
+        own = inventory_share(guest);
+    else
+        rc = snap_restore_inventory(m, ss->avatar_inventory_off, &own);
+    if (rc < 0) {
+        items_clear_all(&guest);
+        return rc;
+    }
+
+    session_h h = session_open();
+    session *s = session_get(h);
+    if (!s) {
+        items_clear_all(&guest);
+        items_clear_all(&own);
+        return -ENOMEM;
+    }
+    s->inventory = guest;
+    if (has_avatar) {
+        ml_handle ah = pool_alloc(&avatar_pool);
+        avatar *av = avatar_get(ah);
+        if (!av) {
+            items_clear_all(&own);
+            session_close(h);
+            return -ENOMEM;
+        }
+        memcpy(av->username, ss->username, MAX_LENGTH-1);
+        memcpy(av->access_code, ss->access_code, MAX_LENGTH-1);
+        av->inventory = own;
+        s->current_avatar = ah;
+        s->is_active = 0x1337;
+        // Membership is checked again against the current directory.
+        if (verify_black_sun_member(av->username, av->access_code) == 1)
+            s->is_blacksun_member = 0x1337;
+    }
+    if (ss->flags & SNAP_HAS_START_LOC) {
+        char name[MAX_LENGTH];
+        memcpy(name, ss->start_loc, MAX_LENGTH-1);
+        name[MAX_LENGTH-1] = '\0';
+        set_start_location_name(h, name);
+    }
+    *out = h;
+    return 0;
+}
+
+// Restores up to max sessions; returns how many, or -errno.
+int snapshot_load(const char *path, session_h *sessions, size_t max) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -errno;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(snap_header)) {
+        int rc = errno ? -errno : -EINVAL;
+        close(fd);
+        return rc;
+    }
+    snap_map *m = calloc(1, sizeof(*m));
+    void *data = MAP_FAILED;
+    if (m) data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        free(m);
+        return m ? -errno : -ENOMEM;
+    }
+    m->data = data;
+    m->len = (size_t)st.st_size;
+    atomic_init(&m->refs, 1);       // held while restoring
+
+    const snap_header *hdr = (const snap_header *)m->data;
+    const snap_session *ss = NULL;
+    int rc = -EINVAL;
+    if (memcmp(hdr->magic, SNAP_MAGIC, sizeof(hdr->magic)) == 0 &&
+        hdr->version == SNAP_VERSION && hdr->endian == SNAP_ENDIAN &&
+        hdr->file_size == m->len)
+        ss = snap_at(m, hdr->sessions_off, hdr->nsessions, sizeof(*ss));
+
+    size_t done = 0;
+    if (ss) {
+        rc = 0;
+        for (; done < hdr->nsessions && done < max; done++) {
+            rc = snap_restore_session(m, &ss[done], &sessions[done]);
+            if (rc < 0) break;
+        }
+        if (rc < 0) {
+            while (done > 0) session_close(sessions[--done]);
+        }
+    }
+    snap_map_release(m);
+    return rc < 0 ? rc : (int)done;
 }
 
 // ============================================================================
 // RENDER CALLBACKS
 // ============================================================================
-void render_ascii(void) {
-    avatar *av = g_session.current_avatar;
+void render_ascii(session_h sess) {
+    session *s = session_get(sess);
+    if (!s) return;
+    avatar *av = avatar_get(s->current_avatar);
     if (!av) {
-        printf("[RENDER] No avatar loaded\n");
+        fprintf(session_out(sess), "[RENDER] No avatar loaded\n");
         return;
     }
-    printf("\n");
-    printf("╔═══════════════════════════════════════════╗\n");
-    printf("║     METAVERSE AVATAR (Standard)           ║\n");
-    printf("╠═══════════════════════════════════════════╣\n");
-    printf("║ Username: ");
-    if (av->username) {
-        for (int i = 0; i < 16 && av->username[i] != '\0'; i++) {
+    render_buf *rb = &s->render;
+    rb_literal(rb, ASCII_BOX_TOP);
+    size_t shown = strnlen(av->username, MAX_LENGTH-1);
+    char *p = rb_reserve(rb, shown);
+    if (p) {
+        size_t n = 0;
+        for (size_t i = 0; i < shown; i++) {
             unsigned char c = av->username[i];
-            if (c >= 0x20 && c <= 0x7E) putchar(c);
+            if (c >= 0x20 && c <= 0x7E) p[n++] = (char)c;
         }
-    } else {
-        printf("NULL");
+        rb->len += n;
     }
-    printf("%*s║\n", (int)(32 - strnlen(av->username, MAX_LENGTH-1)), "");
-    printf("╚═══════════════════════════════════════════╝\n");
-    printf("\n");
+    rb_fill(rb, ' ', 32 - shown);
+    rb_literal(rb, ASCII_BOX_BOTTOM);
+    rb_flush(s);
 }
 
-void print16_hex(const char *buf) {
-    const unsigned char *b = (const unsigned char *)buf;
-    printf("║ ");
-    for (int i = 0; i < 16; i++) {
-        printf("%02X", b[i]);
-        if (i == 7) printf(" | ");
-        else if (i != 15) printf(" ");
-    }
-    printf(" ║ \n");
-}
-
-void render_hex(void) {
-    avatar *av = g_session.current_avatar;
+void render_hex(session_h sess) {
+    session *s = session_get(sess);
+    if (!s) return;
+    avatar *av = avatar_get(s->current_avatar);
     if (!av) {
-        printf("[RENDER] No avatar loaded\n");
+        fprintf(session_out(sess), "[RENDER] No avatar loaded\n");
         return;
     }
-    printf("\n");
-    printf("╔═══════════════════════════════════════════════════╗\n");
-    printf("║     METAVERSE AVATAR (Black Sun)                  ║\n");
-    printf("╠═══════════════════════════════════════════════════╣\n");
-    printf("║ LEET USER (can read hex):                         ║\n");
-    printf("╠═══════════════════════════════════════════════════╣\n");
-    if (av->username) {
-        print16_hex(av->username);
-        printf("╠═══════════════════════════════════════════════════╣\n");
-        if (g_session.start_loc) {
-            start_loc *sl = g_session.start_loc;
-            if (sl) {
-                printf("║ Here's where you're headed:                       ║\n");
-                if (g_session.is_port) {
-                    printf("║   Port: %-41s ║\n", sl->location_name);
-                    uint32_t ux = (sl->coordinates[0] << 24) | (sl->coordinates[1] << 16) |
-                                (sl->coordinates[2] << 8)  |  sl->coordinates[3];
-                    uint32_t uy = (sl->coordinates[4] << 24) | (sl->coordinates[5] << 16) |
-                                (sl->coordinates[6] << 8)  |  sl->coordinates[7];
-                    printf("║   Coordinates -> X=0x%08X Y=0x%08X        ║\n", ux, uy);
-                } else {
-                    printf("║   Name: %-41s ║\n", sl->location_name);
-                }
+    render_buf *rb = &s->render;
+    rb_literal(rb, HEX_BOX_TOP);
+    rb_hex16(rb, av->username);
+    rb_literal(rb, HEX_BOX_RULE);
+    if (s->start_loc) {
+        start_loc *sl = start_loc_get(s->start_loc);
+        if (sl) {
+            rb_literal(rb, HEX_BOX_HEADED);
+            if (s->is_port && sl->coordinates) {
+                rb_literal(rb, "║   Port: ");
+                rb_padded(rb, sl->location_name, MAX_LENGTH, 41);
+                rb_literal(rb, " ║\n");
+                uint32_t ux = ((uint32_t)sl->coordinates[0] << 24) | (sl->coordinates[1] << 16) |
+                              (sl->coordinates[2] << 8)  |  sl->coordinates[3];
+                uint32_t uy = ((uint32_t)sl->coordinates[4] << 24) | (sl->coordinates[5] << 16) |
+                              (sl->coordinates[6] << 8)  |  sl->coordinates[7];
+                rb_literal(rb, "║   Coordinates -> X=0x");
+                rb_hex32(rb, ux);
+                rb_literal(rb, " Y=0x");
+                rb_hex32(rb, uy);
+                rb_literal(rb, "        ║\n");
+            } else {
+                rb_literal(rb, "║   Name: ");
+                rb_padded(rb, sl->location_name, MAX_LENGTH, 41);
+                rb_literal(rb, " ║\n");
             }
         }
-    } else {
-        printf("║ NULL                                     ║\n");
     }
-    printf("╚═══════════════════════════════════════════════════╝\n");
-    printf("\n");
+    rb_literal(rb, HEX_BOX_BOTTOM);
+    rb_flush(s);
 }
 
 void clear_screen(void) {
@@ -450,11 +1522,13 @@ void show_menu(void) {
     printf("Choice: ");
 }
 
-void test_render(void) {
-    if (g_session.is_blacksun_member) {
-        render_functions[0]();
+void test_render(session_h sess) {
+    session *s = session_get(sess);
+    if (!s) return;
+    if (s->is_blacksun_member) {
+        render_functions[0](sess);
     } else {
-        render_functions[1]();
+        render_functions[1](sess);
     }
 }
 
@@ -469,31 +1543,603 @@ void print_banner(void) {
     printf("\n");
 }
 
-void init_system(void) {
-    print_banner();
-    printf("[BOOT] Initializing MetaLogin system...\n");
-    g_session.current_avatar = NULL;
-    g_session.session_id = strdup("SESSION-4471");
-    g_session.is_active = 0;
-    g_session.is_blacksun_member = 0;
-
+// Sets up the render table without any console output (batch replay).
+void init_render_table(void) {
+    ML_STATS_INIT();
+    ML_JOURNAL_INIT();
     render_functions = calloc(4, sizeof(func_t));
     if (render_functions == (func_t *)NULL) {
         printf("[ERROR] system out of resources");
         exit(137);
     }
     render_functions[0]=test_render;
-    render_functions[1]=print_card;
-    printf("[LIBRARIAN] Maybe this will help(%p)\n", print_card);
+    render_functions[1]=(func_t)print_card;
     render_functions[0]=render_hex;
     render_functions[1]=render_ascii;
 }
 
-#ifndef KLEE_DRIVER_BUILD
-int main(void) {
+void init_system(void) {
+    print_banner();
+    printf("[BOOT] Initializing MetaLogin system...\n");
+    init_render_table();
+    printf("[LIBRARIAN] Maybe this will help(%p)\n", print_card);
+}
+
+// ============================================================================
+// COMMAND DISPATCH
+// ============================================================================
+// One menu operation per line: "<choice> [args]". Arguments are separated by
+// spaces and the last one runs to the end of the line, e.g.
+// "1 hiro_p lb_of_Bacon", "3 127", "5 42 katana", "6 42".
+//
+// Lines are parsed in place as (pointer, length) spans, so batch replay can
+// run straight off a read-only mapping of the script.
+typedef struct arg_span {
+    const char *p;
+    size_t      n;
+} arg_span;
+
+static int next_arg(const char **cursor, const char *end, int last, arg_span *out) {
+    const char *p = *cursor;
+    while (p < end && *p == ' ') p++;
+    if (p == end) return 0;
+    const char *e = p;
+    if (last) {
+        e = end;
+    } else {
+        while (e < end && *e != ' ') e++;
+    }
+    out->p = p;
+    out->n = (size_t)(e - p);
+    *cursor = e;
+    return 1;
+}
+
+// Copies an argument into a NUL-terminated buffer, truncating like strncpy
+// into a field of cap-1 characters.
+static void arg_copy(char *dst, size_t cap, arg_span a) {
+    size_t n = a.n < cap - 1 ? a.n : cap - 1;
+    memcpy(dst, a.p, n);
+    dst[n] = '\0';
+}
+
+static int parse_long(arg_span a, long *out_val) {
+    char buf[24];
+    if (a.n == 0 || a.n >= sizeof(buf)) return 0;
+    arg_copy(buf, sizeof(buf), a);
+    char *end = NULL;
+    errno = 0;
+    *out_val = strtol(buf, &end, 10);
+    return errno == 0 && end != buf && *end == '\0';
+}
+
+static int dispatch_line(session_h sess, const char *line, size_t len, int *op) {
+    FILE *out = session_out(sess);
+    const char *cursor = line, *end = line + len;
+    if (len && end[-1] == '\r') end--;
+    arg_span choice, arg;
+    if (!next_arg(&cursor, end, 0, &choice) || choice.n != 1 ||
+        choice.p[0] < '0' || choice.p[0] > '9') {
+        fprintf(out, "[ERROR] Invalid input\n");
+        return -1;
+    }
+
+    long num;
+    *op = choice.p[0] - '0';
+    switch (choice.p[0]) {
+        case '1': {
+            char username[16] = {0};
+            char access_code[16] = {0};
+            if (!next_arg(&cursor, end, 0, &arg)) break;
+            arg_copy(username, sizeof(username), arg);
+            if (!next_arg(&cursor, end, 1, &arg)) break;
+            arg_copy(access_code, sizeof(access_code), arg);
+            set_avatar(sess, username, access_code);
+            return 0;
+        }
+        case '2': clear_avatar(sess); return 0;
+        case '3': {
+            char name[MAX_LENGTH];
+            if (!next_arg(&cursor, end, 1, &arg)) break;
+            arg_copy(name, sizeof(name), arg);
+            set_start_location_name(sess, name);
+            return 0;
+        }
+        case '4': clear_start_location(sess); return 0;
+        case '5': {
+            char name[MAX_LENGTH];
+            if (!next_arg(&cursor, end, 0, &arg) || !parse_long(arg, &num)) break;
+            if (!next_arg(&cursor, end, 1, &arg)) break;
+            arg_copy(name, sizeof(name), arg);
+            if (inventory_add(sess, name, num) == 0)
+                fprintf(out, "[SYSTEM] Item added.\n");
+            else
+                fprintf(out, "[ERROR] Failed to add item.\n");
+            return 0;
+        }
+        case '6': {
+            if (!next_arg(&cursor, end, 1, &arg) || !parse_long(arg, &num)) break;
+            int result = inventory_remove_by_obj(sess, (int)num);
+            if (result > 0)
+                fprintf(out, "[SYSTEM] Item removed.\n");
+            else if (result == 0)
+                fprintf(out, "[ERROR] Item not found.\n");
+            else
+                fprintf(out, "[ERROR] Error removing item.\n");
+            return 0;
+        }
+        case '7': view_inventory(sess); return 0;
+        case '8': inventory_clear_all(sess); return 0;
+        case '9': test_render(sess); return 0;
+        case '0': fprintf(out, "[SYSTEM] Shutting down...\n"); return 1;
+    }
+    fprintf(out, "[ERROR] Invalid arguments\n");
+    return -1;
+}
+
+// Returns 1 when the line asks to exit, 0 when it ran, -1 when it was invalid.
+// len excludes the line terminator.
+int metalogin_dispatch_n(session_h sess, const char *line, size_t len) {
+    int op = -1;
+    ML_STATS_OP_BEGIN(t0);
+    int rc = dispatch_line(sess, line, len, &op);
+    ML_STATS_OP_END(t0, op);
+    return rc;
+}
+
+int metalogin_dispatch(session_h sess, char *line) {
+    return metalogin_dispatch_n(sess, line, strcspn(line, "\r\n"));
+}
+
+// ============================================================================
+// BULK IMPORT / EXPORT
+// ============================================================================
+// Streams are processed ITEMS_BATCH records at a time: each batch reserves
+// slab and index space once, then links its items in one pass.
+#define ITEMS_BATCH  4096
+#define ITEMS_IO     (1 << 16)
+
+static int write_all(int fd, const char *p, size_t n) {
+    while (n) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return -errno;
+        p += w;
+        n -= (size_t)w;
+    }
+    return 0;
+}
+
+static int items_emit(render_buf *rb, int fd, int format, long obj, const char *name) {
+    if (format == ML_ITEMS_BINARY) {
+        snap_item rec = { .inventory_obj = obj };
+        strncpy(rec.thingname, name, MAX_LENGTH-1);
+        rb_append(rb, (const char *)&rec, sizeof(rec));
+    } else {
+        rb_long(rb, obj);
+        rb_literal(rb, " ");
+        rb_append(rb, name, strnlen(name, MAX_LENGTH-1));
+        rb_literal(rb, "\n");
+    }
+    if (rb->len < ITEMS_IO) return 0;
+    int rc = write_all(fd, rb->data, rb->len);
+    rb->len = 0;
+    return rc;
+}
+
+// Writes the session's inventory oldest first; returns the item count or
+// -errno.
+long inventory_export(session_h sess, int fd, int format) {
+    session *s = session_get(sess);
+    if (!s) return -EINVAL;
+    inventory **invp = inventory_slot(s);
+    const inventory *inv = invp ? *invp : NULL;
+    render_buf rb = {0};
+    long n = 0;
+    int rc = 0;
+    if (format == ML_ITEMS_BINARY) {
+        items_header hdr = { .version = ITEMS_VERSION, .record_size = sizeof(snap_item) };
+        memcpy(hdr.magic, ITEMS_MAGIC, sizeof(hdr.magic));
+        rb_append(&rb, (const char *)&hdr, sizeof(hdr));
+    }
+    if (inv) {
+        for (size_t r = inv->base_count; rc == 0 && r-- > 0; ) {
+            if (base_is_removed(inv, r)) continue;
+            rc = items_emit(&rb, fd, format, (long)inv->base[r].inventory_obj,
+                            inv->base[r].thingname);
+            n++;
+        }
+        for (const item *it = inv->tail; rc == 0 && it; it = it->prev) {
+            rc = items_emit(&rb, fd, format, it->inventory_obj, it->thingname);
+            n++;
+        }
+    }
+    if (rc == 0 && rb.len) rc = write_all(fd, rb.data, rb.len);
+    free(rb.data);
+    return rc < 0 ? rc : n;
+}
+
+typedef struct import_rec {
+    long obj;
+    char name[MAX_LENGTH];
+} import_rec;
+
+static void import_batch(inventory **invp, const import_rec *recs, size_t n) {
+    if (!n) return;
+    inventory_reserve(inventory_writable(invp), n);
+    for (size_t i = 0; i < n; i++)
+        items_add(invp, recs[i].name, recs[i].obj);
+}
+
+// Parses the complete text lines in buf into recs; returns the bytes
+// consumed, or -EINVAL on a malformed line.
+static long import_parse_text(const char *buf, size_t len, int final,
+                              import_rec *recs, size_t *nrecs) {
+    const char *p = buf, *end = buf + len;
+    *nrecs = 0;
+    while (p < end && *nrecs < ITEMS_BATCH) {
+        const char *eol = memchr(p, '\n', (size_t)(end - p));
+        if (!eol) {
+            if (!final) break;
+            eol = end;
+        }
+        const char *line_end = eol;
+        if (line_end > p && line_end[-1] == '\r') line_end--;
+        if (line_end > p && p[0] != '#') {
+            const char *cursor = p;
+            arg_span id, name;
+            if (!next_arg(&cursor, line_end, 0, &id) || !parse_long(id, &recs[*nrecs].obj) ||
+                !next_arg(&cursor, line_end, 1, &name))
+                return -EINVAL;
+            arg_copy(recs[*nrecs].name, MAX_LENGTH, name);
+            (*nrecs)++;
+        }
+        p = eol < end ? eol + 1 : end;
+    }
+    return (long)(p - buf);
+}
+
+// Appends the items in a stream to the session's inventory in stream order.
+// Returns the number imported, or -errno; items before a malformed record
+// stay imported.
+long inventory_import(session_h sess, int fd, int format) {
+    session *s = session_get(sess);
+    if (!s) return -EINVAL;
+    inventory **invp = inventory_slot(s);
+    if (!invp) return -EINVAL;
+
+    size_t cap = ITEMS_IO, len = 0;
+    char *buf = malloc(cap);
+    import_rec *recs = malloc(ITEMS_BATCH * sizeof(*recs));
+    long total = 0, rc = 0;
+    int eof = 0, header = format == ML_ITEMS_BINARY;
+    if (!buf || !recs) {
+        rc = -ENOMEM;
+        goto out;
+    }
+    while (!eof || len) {
+        if (!eof && len < cap) {
+            ssize_t n = read(fd, buf + len, cap - len);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                rc = -errno;
+                goto out;
+            }
+            if (n == 0) eof = 1;
+            len += (size_t)n;
+            if (!eof && len < cap) continue;
+        }
+
+        size_t used = 0, nrecs = 0;
+        if (format == ML_ITEMS_BINARY) {
+            if (header) {
+                const items_header *h = (const items_header *)buf;
+                if (len < sizeof(*h) || memcmp(h->magic, ITEMS_MAGIC, sizeof(h->magic)) != 0 ||
+                    h->version != ITEMS_VERSION || h->record_size != sizeof(snap_item)) {
+                    rc = -EINVAL;
+                    goto out;
+                }
+                used = sizeof(*h);
+                header = 0;
+            }
+            while (nrecs < ITEMS_BATCH && len - used >= sizeof(snap_item)) {
+                snap_item rec;
+                memcpy(&rec, buf + used, sizeof(rec));
+                recs[nrecs].obj = (long)rec.inventory_obj;
+                memcpy(recs[nrecs].name, rec.thingname, MAX_LENGTH-1);
+                recs[nrecs].name[MAX_LENGTH-1] = '\0';
+                nrecs++;
+                used += sizeof(snap_item);
+            }
+            if (eof && nrecs == 0 && len - used) {
+                rc = -EINVAL;       // trailing partial record
+                goto out;
+            }
+        } else {
+            long r = import_parse_text(buf, len, eof, recs, &nrecs);
+            if (r < 0) {
+                rc = r;
+                goto out;
+            }
+            used = (size_t)r;
+            if (!used && !eof && len == cap) {
+                // One line fills the buffer: grow it.
+                char *grown = realloc(buf, cap * 2);
+                if (!grown) {
+                    rc = -ENOMEM;
+                    goto out;
+                }
+                buf = grown;
+                cap *= 2;
+                continue;
+            }
+        }
+        import_batch(invp, recs, nrecs);
+        total += (long)nrecs;
+        memmove(buf, buf + used, len - used);
+        len -= used;
+        if (eof && !nrecs && !used) break;
+    }
+out:
+    free(buf);
+    free(recs);
+    ML_JOURNAL(sess, JOURNAL_ITEM_IMPORT, (int)rc, total, NULL);
+    return rc < 0 ? rc : total;
+}
+
+#if !defined(KLEE_DRIVER_BUILD) && !defined(METALOGIN_NO_MAIN)
+// ============================================================================
+// SESSION PERSISTENCE
+// ============================================================================
+// METALOGIN_SNAPSHOT=path restores the session from path at startup (if the
+// file exists) and saves it back on exit.
+static session_h open_main_session(FILE *log) {
+    const char *path = getenv("METALOGIN_SNAPSHOT");
+    session_h sess = ML_NULL_HANDLE;
+    if (path) {
+        int n = snapshot_load(path, &sess, 1);
+        if (n == 1)
+            fprintf(log, "[BOOT] Restored session from %s\n", path);
+        else if (n < 0 && n != -ENOENT)
+            fprintf(log, "[ERROR] Could not restore %s: %s\n", path, strerror(-n));
+    }
+    if (!sess) sess = session_open();
+    if (!sess) {
+        fprintf(log, "[ERROR] system out of resources\n");
+        exit(137);
+    }
+    return sess;
+}
+
+static void save_main_session(session_h sess, FILE *log) {
+    const char *path = getenv("METALOGIN_SNAPSHOT");
+    if (!path) return;
+    int rc = snapshot_save(path, &sess, 1);
+    if (rc < 0)
+        fprintf(log, "[ERROR] Could not save %s: %s\n", path, strerror(-rc));
+}
+
+// ============================================================================
+// BATCH REPLAY
+// ============================================================================
+// "metalogin -b script" replays a command script, one metalogin_dispatch line
+// per operation, with no banner, menu or prompts; "-b -" streams it from
+// stdin. Blank lines and lines starting with '#' are skipped. Script files are
+// memory-mapped and parsed in place; output goes through one large stdio
+// buffer.
+#define BATCH_CHUNK (1 << 16)
+
+typedef struct batch_stats {
+    long ops;
+    long invalid;
+    int  exited;
+} batch_stats;
+
+// Runs the complete lines in buf and returns the bytes consumed. A trailing
+// line without '\n' only runs when final is set.
+static size_t batch_lines(session_h sess, const char *buf, size_t len, int final,
+                          batch_stats *st) {
+    const char *p = buf, *end = buf + len;
+    while (p < end && !st->exited) {
+        const char *eol = memchr(p, '\n', (size_t)(end - p));
+        if (!eol) {
+            if (!final) break;
+            eol = end;
+        }
+        size_t n = (size_t)(eol - p);
+        if (n && p[0] != '#' && !(n == 1 && p[0] == '\r')) {
+            int rc = metalogin_dispatch_n(sess, p, n);
+            st->ops++;
+            if (rc < 0) st->invalid++;
+            if (rc == 1) st->exited = 1;
+        }
+        p = eol < end ? eol + 1 : end;
+    }
+    return (size_t)(p - buf);
+}
+
+static int batch_stream(session_h sess, int fd, batch_stats *st) {
+    size_t cap = BATCH_CHUNK, len = 0;
+    char *buf = malloc(cap);
+    if (!buf) return -ENOMEM;
+    while (!st->exited) {
+        if (len == cap) {
+            // One line fills the buffer: grow it rather than split the line.
+            char *grown = realloc(buf, cap * 2);
+            if (!grown) {
+                free(buf);
+                return -ENOMEM;
+            }
+            buf = grown;
+            cap *= 2;
+        }
+        ssize_t n = read(fd, buf + len, cap - len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            int rc = -errno;
+            free(buf);
+            return rc;
+        }
+        if (n == 0) {
+            batch_lines(sess, buf, len, 1, st);
+            break;
+        }
+        len += (size_t)n;
+        size_t used = batch_lines(sess, buf, len, 0, st);
+        memmove(buf, buf + used, len - used);
+        len -= used;
+    }
+    free(buf);
+    return 0;
+}
+
+static int batch_mapped(session_h sess, int fd, batch_stats *st) {
+    struct stat sb;
+    if (fstat(fd, &sb) < 0) return -errno;
+    if (sb.st_size == 0) return 0;
+    char *map = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) return -errno;
+    madvise(map, (size_t)sb.st_size, MADV_SEQUENTIAL);
+    batch_lines(sess, map, (size_t)sb.st_size, 1, st);
+    munmap(map, (size_t)sb.st_size);
+    return 0;
+}
+
+typedef struct batch_opts {
+    const char *script;         // NULL: nothing to replay
+    const char *import_path;
+    int         import_format;
+    const char *export_path;
+    int         export_format;
+} batch_opts;
+
+static double elapsed_since(const struct timespec *t0) {
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (double)(t1.tv_sec - t0->tv_sec) + (double)(t1.tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+static int batch_import(session_h sess, const char *path, int format) {
+    int fd = strcmp(path, "-") == 0 ? STDIN_FILENO : open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    long n = inventory_import(sess, fd, format);
+    if (fd != STDIN_FILENO) close(fd);
+    if (n < 0) {
+        fprintf(stderr, "[ERROR] Import from %s failed: %s\n", path, strerror((int)-n));
+        return -1;
+    }
+    fprintf(stderr, "[BATCH] Imported %ld items from %s in %.3f s\n", n, path, elapsed_since(&t0));
+    return 0;
+}
+
+static int batch_export(session_h sess, const char *path, int format) {
+    fflush(stdout);
+    int fd = strcmp(path, "-") == 0 ? STDOUT_FILENO
+                                    : open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    long n = inventory_export(sess, fd, format);
+    if (fd != STDOUT_FILENO) close(fd);
+    if (n < 0) {
+        fprintf(stderr, "[ERROR] Export to %s failed: %s\n", path, strerror((int)-n));
+        return -1;
+    }
+    fprintf(stderr, "[BATCH] Exported %ld items to %s in %.3f s\n", n, path, elapsed_since(&t0));
+    return 0;
+}
+
+static int batch_replay(const batch_opts *o) {
+    static char outbuf[BATCH_CHUNK];
+    setvbuf(stdout, outbuf, _IOFBF, sizeof(outbuf));
+    init_render_table();
+    const char *directory = getenv("METALOGIN_BLACKSUN_DIR");
+    if (directory) {
+        int n = blacksun_load(directory);
+        if (n < 0)
+            fprintf(stderr, "[ERROR] Could not load Black Sun directory %s: %s\n",
+                    directory, strerror(-n));
+    }
+    int fd = -1;
+    if (o->script) {
+        fd = strcmp(o->script, "-") == 0 ? STDIN_FILENO : open(o->script, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            perror(o->script);
+            return 1;
+        }
+    }
+    session_h sess = open_main_session(stderr);
+    session_get(sess)->out = stdout;
+
+    int status = 0;
+    if (o->import_path && batch_import(sess, o->import_path, o->import_format) < 0)
+        status = 1;
+    if (status == 0 && fd >= 0) {
+        batch_stats st = {0};
+        struct timespec t0;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        int rc = fd == STDIN_FILENO ? batch_stream(sess, fd, &st) : batch_mapped(sess, fd, &st);
+        fflush(stdout);
+        double elapsed = elapsed_since(&t0);
+        if (rc < 0) {
+            fprintf(stderr, "[ERROR] %s: %s\n", o->script, strerror(-rc));
+            status = 1;
+        } else {
+            fprintf(stderr, "[BATCH] %ld operations (%ld invalid) in %.3f s: %.0f ops/sec\n",
+                    st.ops, st.invalid, elapsed, elapsed > 0 ? (double)st.ops / elapsed : 0.0);
+        }
+    }
+    if (fd >= 0 && fd != STDIN_FILENO) close(fd);
+    if (status == 0 && o->export_path && batch_export(sess, o->export_path, o->export_format) < 0)
+        status = 1;
+    fflush(stdout);
+    save_main_session(sess, stderr);
+    session_close(sess);
+    return status;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-b script|-] [-i items.txt|-I items.bin] [-e items.txt|-E items.bin]\n",
+            argv0);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    batch_opts o = {0};
+    int opt;
+    while ((opt = getopt(argc, argv, "b:i:I:e:E:")) != -1) {
+        switch (opt) {
+            case 'b': o.script = optarg; break;
+            case 'i': o.import_path = optarg; o.import_format = ML_ITEMS_TEXT; break;
+            case 'I': o.import_path = optarg; o.import_format = ML_ITEMS_BINARY; break;
+            case 'e': o.export_path = optarg; o.export_format = ML_ITEMS_TEXT; break;
+            case 'E': o.export_path = optarg; o.export_format = ML_ITEMS_BINARY; break;
+            default: usage(argv[0]);
+        }
+    }
+    if (optind != argc) usage(argv[0]);
+    if (o.script || o.import_path || o.export_path)
+        return batch_replay(&o);
     setbuf(stdout, NULL);
     setbuf(stdin, NULL);
     init_system();
+    const char *directory = getenv("METALOGIN_BLACKSUN_DIR");
+    if (directory) {
+        int n = blacksun_load(directory);
+        if (n < 0)
+            printf("[ERROR] Could not load Black Sun directory %s: %s\n", directory, strerror(-n));
+        else
+            printf("[BOOT] Loaded %d Black Sun members from %s\n", n, directory);
+    }
+    session_h sess = open_main_session(stdout);
     int choice;
     while (1) {
         show_menu();
@@ -503,6 +2149,7 @@ int main(void) {
             continue;
         }
         while (getchar() != '\n');
+        ML_STATS_OP_BEGIN(t0);
         switch (choice) {
             case 1: {
                 char username[16] = {0};
@@ -513,20 +2160,25 @@ int main(void) {
                 printf("Enter access code: ");
                 if (fgets(access_code, sizeof(access_code), stdin))
                     access_code[strcspn(access_code, "\n")] = 0;
-                set_avatar(username, access_code);
+                set_avatar(sess, username, access_code);
                 break;
             }
-            case 2: clear_avatar(); break;
-            case 3: set_start_location(); break;
-            case 4: clear_start_location(); break;
-            case 5: add_item_from_user(); break;
-            case 6: remove_item_from_user(); break;
-            case 7: view_inventory(); break;
-            case 8: inventory_clear_all(); break;
-            case 9: test_render(); break;
-            case 0: printf("[SYSTEM] Shutting down...\n"); return 0;
+            case 2: clear_avatar(sess); break;
+            case 3: set_start_location(sess); break;
+            case 4: clear_start_location(sess); break;
+            case 5: add_item_from_user(sess); break;
+            case 6: remove_item_from_user(sess); break;
+            case 7: view_inventory(sess); break;
+            case 8: inventory_clear_all(sess); break;
+            case 9: test_render(sess); break;
+            case 0:
+                printf("[SYSTEM] Shutting down...\n");
+                save_main_session(sess, stdout);
+                session_close(sess);
+                return 0;
             default: printf("[ERROR] Invalid choice\n");
         }
+        ML_STATS_OP_END(t0, choice);
     }
     return 0;
 }
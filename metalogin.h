@@ -13,26 +13,72 @@
 #include <ctype.h>
 #include <limits.h>
 #include <errno.h>
-#include <math.h>
+#include <stdatomic.h>
+#include <unistd.h>
 
 #define MAX_LENGTH  16
 #define NUM_BLACK_SUN_MEMBERS 4
+#define NUM_PORTS 256
+#define ML_CACHE_LINE 64
+
+// KLEE builds keep every object on the system heap: pooled slots would hide
+// use-after-free from KLEE's memory checker.
+#if defined(KLEE_DRIVER_BUILD) && !defined(METALOGIN_SYSTEM_ALLOC)
+#define METALOGIN_SYSTEM_ALLOC
+#endif
 extern const char *black_sun_member_usernames[];
 extern const char *black_sun_member_access_codes[];
 
+// Black Sun member directory (blacksun.c): a minimal perfect hash over
+// usernames. Strings are not NUL-terminated when they point into a mapped
+// directory file.
+typedef struct bs_member {
+    const char *username;
+    uint32_t  username_len;
+    const char *access_code;
+    uint32_t  access_code_len;
+} bs_member;
+
+typedef struct bs_directory {
+    uint32_t  nmembers;
+    uint32_t  nbuckets;
+    const uint32_t *seeds;      // per bucket
+    const bs_member *slots;     // nmembers
+    void      *map;             // backing file mapping, if any
+    size_t    map_len;
+} bs_directory;
+
+extern const bs_directory black_sun_builtin_directory;
+
+uint64_t blacksun_hash(const char *, size_t, uint32_t);
+int blacksun_build(bs_directory *, const bs_member *, uint32_t);
+int blacksun_load(const char *);
+void blacksun_reset(void);
+int blacksun_verify(const char *, const char *);
+
 // ============================================================================
 // STRUCTURE DEFINITIONS
 // ============================================================================
 typedef struct avatar {
-    void      *inventory;
-    char      *access_code;
-    char      *username;
+    struct inventory *inventory;
+    char      access_code[MAX_LENGTH];   // stored inline: one allocation per login
+    char      username[MAX_LENGTH];
     char      expansion_slot[MAX_LENGTH];
 } avatar;
 
-typedef struct start_loc {
-    char      *location_name;
+// One entry per Street port. Coordinates are the port's place on the ring,
+// 16.16 fixed point biased by 0x80000000, big-endian X then Y.
+typedef struct port_entry {
+    char      name[4];
     uint8_t   coordinates[8];
+} port_entry;
+
+extern const port_entry port_catalog[NUM_PORTS];   // generated, see port_gen.c
+
+typedef struct start_loc {
+    const char    *location_name;   // custom_name, as the user typed it
+    const uint8_t *coordinates;     // port_catalog entry; NULL off the ring
+    char          custom_name[MAX_LENGTH];
 } start_loc;
 
 typedef struct item {
@@ -40,26 +86,366 @@ typedef struct item {
     char      thingname[MAX_LENGTH];
     struct item  *next;
     int       internal_use_only;
+    struct item  *prev;
+    struct item  *older;        // previous item with the same inventory_obj
 } item;
 
+// Item nodes are carved from per-inventory slabs; each new slab doubles in
+// size so an inventory of n items costs O(log n) allocations.
+#define INVENTORY_SLAB_MIN   16
+#define INVENTORY_INDEX_MIN  32
+
+typedef struct item_slab {
+    struct item_slab *next;
+    size_t    nitems;
+    item      items[];
+} item_slab;
+
+// ============================================================================
+// SNAPSHOT FORMAT
+// ============================================================================
+// A snapshot file is position independent: every reference is a byte offset
+// from the start of the file or a record number. Values are in host byte
+// order; `endian` lets a reader reject a file from another architecture.
+//
+//   snap_header | per inventory: snap_item[count], uint32_t index[index_cap],
+//   snap_inventory | snap_session[nsessions]
+//
+// A session has a guest inventory and, while logged in, an avatar inventory.
+// Both are stored; an avatar still sharing the guest inventory stores the
+// same offset as the guest.
+#define SNAP_MAGIC     "MLSNAP\0\0"
+#define SNAP_VERSION   1
+#define SNAP_ENDIAN    0x01020304u
+
+enum {
+    SNAP_HAS_AVATAR    = 1u << 0,
+    SNAP_BLACKSUN      = 1u << 1,
+    SNAP_HAS_START_LOC = 1u << 2,
+};
+
+typedef struct snap_header {
+    char      magic[8];
+    uint32_t  version;
+    uint32_t  endian;
+    uint64_t  file_size;
+    uint64_t  sessions_off;
+    uint32_t  nsessions;
+    uint32_t  reserved;
+} snap_header;
+
+// Items are stored newest first, as the inventory lists them.
+typedef struct snap_item {
+    int64_t   inventory_obj;
+    char      thingname[MAX_LENGTH];
+    uint32_t  older;            // next older record with this key, +1; 0 ends
+    uint32_t  reserved;
+} snap_item;
+
+// index[inv_hash(key)] holds the newest record for the key, +1 (linear probing).
+typedef struct snap_inventory {
+    uint64_t  count;
+    uint64_t  index_cap;        // power of two
+    uint64_t  items_off;
+    uint64_t  index_off;
+} snap_inventory;
+
+typedef struct snap_session {
+    char      username[MAX_LENGTH];
+    char      access_code[MAX_LENGTH];
+    char      start_loc[MAX_LENGTH];
+    uint32_t  flags;            // SNAP_*
+    uint32_t  reserved;
+    uint64_t  guest_inventory_off;  // snap_inventory, 0 when empty
+    uint64_t  avatar_inventory_off; // likewise; 0 without SNAP_HAS_AVATAR
+} snap_session;
+
+// Bulk item streams (inventory_import/inventory_export). Text streams hold
+// one "<inventory_obj> <name>" line per item, like menu choice 5; binary
+// streams are an items_header followed by snap_item records. Both list items
+// oldest first, so importing a stream replays the original adds.
+enum {
+    ML_ITEMS_TEXT,
+    ML_ITEMS_BINARY
+};
+
+#define ITEMS_MAGIC    "MLITEMS\0"
+#define ITEMS_VERSION  1
+
+typedef struct items_header {
+    char      magic[8];
+    uint32_t  version;
+    uint32_t  record_size;      // sizeof(snap_item)
+} items_header;
+
+// A mapped snapshot, shared by every inventory restored from it and
+// unmapped when the last one is cleared.
+typedef struct snap_map {
+    const unsigned char *data;
+    size_t    len;
+    atomic_uint refs;
+} snap_map;
+
+// Open-addressing index keyed on inventory_obj. Each slot holds the newest
+// item for its key; older duplicates hang off item->older.
+//
+// An inventory can be shared: logging in hands the guest inventory to the
+// avatar by reference. Writers copy a shared inventory first (copy on
+// write), and the items are freed when the last owner lets go. An
+// inventory is only ever touched by its session's thread.
+//
+// An inventory restored from a snapshot keeps its items in the mapping
+// (base_*) instead of copying them: heap items added later shadow them, and
+// removed records are marked in base_removed.
+typedef struct inventory {
+    item      *head;            // newest first
+    item      *tail;            // oldest
+    item      *free_list;
+    item_slab *slabs;
+    size_t    slab_used;        // items handed out from slabs (the newest one)
+    item      **index;
+    size_t    index_cap;        // power of two
+    size_t    index_used;       // live keys + tombstones
+    size_t    count;            // heap items
+    unsigned  refs;             // owners sharing this inventory
+    snap_map  *base_map;
+    const snap_item *base;
+    const uint32_t *base_index;
+    uint8_t   *base_removed;    // bitmap, allocated on the first removal
+    size_t    base_count;
+    size_t    base_index_cap;
+    size_t    base_live;        // base records not removed
+} inventory;
+
+// Avatars and start locations live in process-wide, sharded pools and are
+// referenced through generation-tagged handles:
+// (generation << 32) | ((slot << 4 | shard) + 1). A stale handle no longer
+// matches its slot's generation and resolves to NULL on any thread. Under
+// METALOGIN_SYSTEM_ALLOC a handle is simply the object's heap address.
+typedef uint64_t ml_handle;
+#define ML_NULL_HANDLE ((ml_handle)0)
+
+// Per-session output buffer: a card is formatted here and written out in one
+// call. The storage is kept and reused for the life of the session.
+typedef struct render_buf {
+    char      *data;
+    size_t    len;
+    size_t    cap;
+} render_buf;
+
 typedef struct session {
-    avatar    *current_avatar;
+    ml_handle current_avatar;
     char      *session_id;
-    void      *inventory;
+    struct inventory *inventory;
     int       is_active;
     int       is_blacksun_member;
     int       is_port;
-    start_loc *start_loc;
+    int       avatar_released;  // clear_avatar freed current_avatar
+    ml_handle start_loc;
+    FILE      *out;             // NULL writes to stdout
+    render_buf render;
 } session;
 
+// Sessions live in a sharded table and are addressed by generation-tagged
+// handles with the same layout as ml_handle.
+typedef ml_handle session_h;
+
+// ============================================================================
+// INSTRUMENTATION
+// ============================================================================
+// Opt-in with -DMETALOGIN_STATS (metalogin_stats.c). The default build
+// compiles every hook below to nothing.
+enum {
+    ML_STAT_AVATAR,
+    ML_STAT_ITEM,
+    ML_STAT_START_LOC,
+    ML_STAT_STRING,
+    ML_STAT_INVENTORY,
+    ML_STAT_SESSION,
+    ML_STAT_RENDER,
+    ML_STAT_TYPES
+};
+
+#define ML_STATS_OPS        10      // menu choices 0..9
+#define ML_STATS_MAX_SITES  64
+#define ML_STATS_MAGIC      0x4D4C5354u     // "MLST"
+#define ML_STATS_VERSION    1
+
+#ifdef METALOGIN_STATS
+typedef struct ml_type_stats {
+    _Atomic uint64_t allocs;
+    _Atomic uint64_t frees;
+    _Atomic int64_t  bytes_in_use;
+    _Atomic int64_t  peak_bytes;
+} ml_type_stats;
+
+typedef struct ml_op_stats {
+    _Atomic uint64_t count;
+    _Atomic uint64_t cycles;
+    _Atomic uint64_t max_cycles;
+} ml_op_stats;
+
+typedef struct ml_site_stats {
+    char             where[48];     // "function:line call"
+    _Atomic uint64_t calls;
+    _Atomic uint64_t bytes;
+} ml_site_stats;
+
+// Fixed layout so another process can map it (METALOGIN_STATS_SHM).
+typedef struct ml_stats_page {
+    uint32_t         magic;
+    uint32_t         version;
+    _Atomic uint32_t nsites;
+    uint32_t         reserved;
+    ml_type_stats    types[ML_STAT_TYPES];
+    ml_op_stats      ops[ML_STATS_OPS];
+    ml_site_stats    sites[ML_STATS_MAX_SITES];
+} ml_stats_page;
+
+extern ml_stats_page *ml_stats;
+
+void ml_stats_init(void);
+void ml_stats_object(int type, int64_t count, int64_t bytes);
+void ml_stats_heap(_Atomic uint32_t *site, const char *func, int line,
+                   const char *call, size_t bytes);
+void ml_stats_op(int choice, uint64_t cycles);
+uint64_t ml_stats_cycles(void);
+void ml_stats_write_json(FILE *, const ml_stats_page *);
+
+#define ML_STATS_INIT()                 ml_stats_init()
+#define ML_STAT_OBJECT(type, n, bytes)  ml_stats_object((type), (int64_t)(n), (int64_t)(bytes))
+#define ML_STATS_OP_BEGIN(t)            uint64_t t = ml_stats_cycles()
+#define ML_STATS_OP_END(t, choice)      ml_stats_op((choice), ml_stats_cycles() - (t))
+#else
+#define ML_STATS_INIT()                 ((void)0)
+#define ML_STAT_OBJECT(type, n, bytes)  ((void)0)
+#define ML_STATS_OP_BEGIN(t)            ((void)0)
+#define ML_STATS_OP_END(t, choice)      ((void)(choice))
+#endif
+
+// ============================================================================
+// AUDIT JOURNAL
+// ============================================================================
+// METALOGIN_JOURNAL=path appends one record per login, logout, start
+// location change and inventory change (metalogin_journal.c). Each session
+// thread fills its own single-producer ring and a writer thread drains the
+// rings into the file, so the request path never touches the file. KLEE
+// builds compile the hooks out.
+enum {
+    JOURNAL_LOGIN = 1,          // name: username; result: 1 granted, -1 denied, 0 user
+    JOURNAL_LOGOUT,             // name: username
+    JOURNAL_START_LOC,          // name: location
+    JOURNAL_START_LOC_CLEAR,
+    JOURNAL_ITEM_ADD,           // arg: inventory_obj; name: item
+    JOURNAL_ITEM_REMOVE,        // arg: inventory_obj; result: items removed
+    JOURNAL_ITEM_CLEAR,
+    JOURNAL_ITEM_IMPORT,        // arg: items imported; result: 0 or -errno
+    JOURNAL_DROPPED,            // arg: records lost to a full ring
+};
+
+#define JOURNAL_MAGIC    "MLJRNL\0\0"
+#define JOURNAL_VERSION  1
+
+// The file is a journal_header followed by fixed-size records in host byte
+// order. Records from one thread are in order; threads interleave.
+typedef struct journal_header {
+    char      magic[8];
+    uint32_t  version;
+    uint32_t  record_size;      // sizeof(journal_rec)
+} journal_header;
+
+typedef struct journal_rec {
+    uint64_t  time_ns;          // CLOCK_REALTIME_COARSE
+    uint64_t  session;          // session_h
+    int64_t   arg;
+    uint16_t  type;             // JOURNAL_*
+    uint16_t  ring;             // producing thread
+    int32_t   result;
+    char      name[MAX_LENGTH]; // NUL-padded, not always terminated
+} journal_rec;
+
+extern atomic_int journal_enabled;
+
+int journal_open(const char *path);
+void journal_close(void);
+void journal_init(void);
+void journal_record(session_h, int type, int result, long arg, const char *name);
+
+#ifndef KLEE_DRIVER_BUILD
+#define ML_JOURNAL_INIT()   journal_init()
+#define ML_JOURNAL(sess, type, result, arg, name)                                   \
+    do {                                                                            \
+        if (atomic_load_explicit(&journal_enabled, memory_order_relaxed))           \
+            journal_record((sess), (type), (result), (arg), (name));                \
+    } while (0)
+#else
+#define ML_JOURNAL_INIT()   ((void)0)
+#define ML_JOURNAL(sess, type, result, arg, name)  ((void)0)
+#endif
+
 // ============================================================================
-// GLOBALS
+// SHADOW HEAP (stubs_wmi2.c)
+// ============================================================================
+// The KLEE build of metalogin.c allocates through these wrappers, which
+// record every chunk's bounds, allocation site and live/freed state.
+// shadow_lookup tells whether addr lies in a recorded chunk: 1 if it is live,
+// 0 if it was freed and not handed out again, -1 if addr is in no recorded
+// chunk. On 0 or 1 the chunk's base, size and site go to the non-NULL out
+// pointers. The lookup is O(log n).
+void *shadow_malloc(size_t n, const char *func, int line);
+void *shadow_calloc(size_t n, size_t size, const char *func, int line);
+void *shadow_realloc(void *p, size_t n, const char *func, int line);
+char *shadow_strdup(const char *s, const char *func, int line);
+void shadow_free(void *p);
+int shadow_lookup(uintptr_t addr, uintptr_t *base, size_t *size,
+                  const char **func, int *line);
+
 // ============================================================================
+// WMI-2 DRIVER (driver_wmi2_leak.c)
+// ============================================================================
+// wmi2_leak_sequence runs set_avatar, clear_avatar, set_start_location on
+// sess and returns the avatar the session still points at. wmi2_leaks is the
+// leak oracle over that avatar. Shared by KLEE, replay_wmi2 and fuzz_wmi2.
+avatar *wmi2_leak_sequence(session_h sess, char *username, char *access_code);
+int wmi2_leaks(const avatar *av, int (*is_heap)(uintptr_t), uintptr_t *leaked);
+
+// ============================================================================
+// API
+// ============================================================================
+
+session_h session_open(void);
+void session_close(session_h);
+session *session_get(session_h);
+
+avatar *avatar_get(ml_handle);
+start_loc *start_loc_get(ml_handle);
+
+int items_add(inventory **, const char *, long);
+int items_remove_by_obj(inventory **, long);
+void items_clear_all(inventory **);
 
-extern session g_session;
+void init_system(void);
+void init_render_table(void);
+void set_avatar(session_h, char *, char *);
+void clear_avatar(session_h);
+void set_start_location(session_h);
+void set_start_location_name(session_h, const char *);
+void clear_start_location(session_h);
+int inventory_add(session_h, const char *, long);
+int inventory_remove_by_obj(session_h, long);
+void inventory_clear_all(session_h);
+void view_inventory(session_h);
+void test_render(session_h);
+void render_hex(session_h);
+void render_ascii(session_h);
+int metalogin_dispatch(session_h, char *);
+int metalogin_dispatch_n(session_h, const char *, size_t);
+long inventory_import(session_h, int fd, int format);
+long inventory_export(session_h, int fd, int format);
+int snapshot_save(const char *, const session_h *, size_t);
+int snapshot_load(const char *, session_h *, size_t);
 
-void set_avatar(char *, char *);
-void clear_avatar(void);
-void print_card(void);
+// Defined by the card module; weak so front ends link without it.
+void print_card(void) __attribute__((weak));
 
 #endif
@@ -0,0 +1,256 @@
+// metalogin_bench.c - MetaLogin Avatar Manager
+// Microbenchmarks for the core operations, reported as JSON.
+//
+// Each benchmark times one operation per iteration with CLOCK_MONOTONIC.
+// Untimed prep/undo steps around it keep the state steady (for example the
+// inventory stays at its nominal size). Session output goes to /dev/null.
+// The cost of the clock reads is measured once and subtracted from every
+// sample.
+#define _GNU_SOURCE
+#include "metalogin.h"
+
+#include <time.h>
+
+#define BENCH_DEFAULT_ITERS  100000
+#define BENCH_WARMUP         1000
+
+typedef struct bench {
+    const char *name;
+    long       param;           // inventory size, or 0
+    void       (*setup)(long param);
+    void       (*prep)(long i);     // untimed, before op
+    void       (*op)(long i);       // timed
+    void       (*undo)(long i);     // untimed, after op
+    void       (*teardown)(void);
+} bench;
+
+static session_h sess;
+static FILE *devnull;
+static uint64_t timer_overhead_ns;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void fresh_session(void) {
+    if (sess) session_close(sess);
+    sess = session_open();
+    if (!sess) {
+        fprintf(stderr, "[ERROR] system out of resources\n");
+        exit(137);
+    }
+    session_get(sess)->out = devnull;
+}
+
+// ============================================================================
+// OPERATIONS
+// ============================================================================
+static char *user_name(long i, char buf[MAX_LENGTH]) {
+    snprintf(buf, MAX_LENGTH, "user%ld", i % 1000);
+    return buf;
+}
+
+static void op_set_avatar(long i) {
+    char name[MAX_LENGTH];
+    set_avatar(sess, user_name(i, name), "code");
+}
+
+static void op_clear_avatar(long i) {
+    (void)i;
+    clear_avatar(sess);
+}
+
+// Inventory benchmarks keep `param` items resident; the timed item uses an
+// ID above that range. The login benchmarks log in over a guest inventory of
+// that size.
+static void setup_inventory(long n) {
+    fresh_session();
+    for (long k = 0; k < n; k++)
+        inventory_add(sess, "filler", k);
+}
+
+static void op_inventory_add(long i) {
+    inventory_add(sess, "katana", LONG_MAX / 2 + i);
+}
+
+static void op_inventory_remove(long i) {
+    inventory_remove_by_obj(sess, LONG_MAX / 2 + i);
+}
+
+static void op_start_port(long i) {
+    (void)i;
+    set_start_location_name(sess, "127");
+}
+
+static void op_start_name(long i) {
+    (void)i;
+    set_start_location_name(sess, "Spiral");
+}
+
+static void op_clear_start(long i) {
+    (void)i;
+    clear_start_location(sess);
+}
+
+static void setup_blacksun(long n) {
+    (void)n;
+    fresh_session();
+    set_avatar(sess, "hiro_p", "lb_of_Bacon");
+    set_start_location_name(sess, "127");
+}
+
+static void setup_standard(long n) {
+    (void)n;
+    fresh_session();
+    set_avatar(sess, "juanita_x", "code");
+}
+
+static void setup_session(long n) {
+    (void)n;
+    fresh_session();
+}
+
+static void op_render_hex(long i) {
+    (void)i;
+    render_hex(sess);
+}
+
+static void op_render_ascii(long i) {
+    (void)i;
+    render_ascii(sess);
+}
+
+// Records go to /dev/null; the writer thread keeps the ring drained.
+static void setup_journal(long n) {
+    (void)n;
+    fresh_session();
+    int rc = journal_open("/dev/null");
+    if (rc < 0) {
+        fprintf(stderr, "[ERROR] Could not open journal: %s\n", strerror(-rc));
+        exit(1);
+    }
+}
+
+static void op_journal_record(long i) {
+    journal_record(sess, JOURNAL_ITEM_ADD, 0, i, "katana");
+}
+
+static void teardown_journal(void) {
+    journal_close();
+    session_close(sess);
+    sess = ML_NULL_HANDLE;
+}
+
+static void teardown_session(void) {
+    session_close(sess);
+    sess = ML_NULL_HANDLE;
+}
+
+// ============================================================================
+// RUNNER
+// ============================================================================
+static void calibrate(void) {
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 10000; i++) {
+        uint64_t t0 = now_ns();
+        uint64_t d = now_ns() - t0;
+        if (d < best) best = d;
+    }
+    timer_overhead_ns = best;
+}
+
+static void run(const bench *b, long iters, uint64_t *samples, FILE *json, int first) {
+    if (b->setup) b->setup(b->param);
+    for (long i = -BENCH_WARMUP; i < iters; i++) {
+        if (b->prep) b->prep(i);
+        uint64_t t0 = now_ns();
+        b->op(i);
+        uint64_t d = now_ns() - t0;
+        if (b->undo) b->undo(i);
+        if (i >= 0) samples[i] = d > timer_overhead_ns ? d - timer_overhead_ns : 0;
+    }
+    if (b->teardown) b->teardown();
+
+    uint64_t total = 0;
+    for (long i = 0; i < iters; i++) total += samples[i];
+    qsort(samples, (size_t)iters, sizeof(*samples), cmp_u64);
+    double mean = (double)total / (double)iters;
+    fprintf(json, "%s\n    {\"name\": \"%s\", \"param\": %ld, \"iterations\": %ld, "
+                  "\"ops_per_sec\": %.0f, \"mean_ns\": %.1f, \"p50_ns\": %llu, \"p99_ns\": %llu}",
+            first ? "" : ",", b->name, b->param, iters,
+            mean > 0 ? 1e9 / mean : 0.0, mean,
+            (unsigned long long)samples[iters / 2],
+            (unsigned long long)samples[iters * 99 / 100]);
+    fprintf(stderr, "[BENCH] %-26s %7ld  p50 %6llu ns  p99 %7llu ns\n", b->name, b->param,
+            (unsigned long long)samples[iters / 2],
+            (unsigned long long)samples[iters * 99 / 100]);
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n iterations] [-o results.json]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    long iters = BENCH_DEFAULT_ITERS;
+    const char *out_path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:o:")) != -1) {
+        switch (opt) {
+            case 'n': iters = atol(optarg); break;
+            case 'o': out_path = optarg; break;
+            default: usage(argv[0]);
+        }
+    }
+    if (iters < 1) usage(argv[0]);
+
+    devnull = fopen("/dev/null", "w");
+    FILE *json = out_path ? fopen(out_path, "w") : stdout;
+    uint64_t *samples = malloc((size_t)iters * sizeof(*samples));
+    if (!devnull || !json || !samples) {
+        perror("setup");
+        return 1;
+    }
+    init_render_table();
+    calibrate();
+
+    const bench benches[] = {
+        { "set_avatar",              0,      setup_session,   NULL,               op_set_avatar,       op_clear_avatar, teardown_session },
+        { "clear_avatar",            0,      setup_session,   op_set_avatar,      op_clear_avatar,     NULL,            teardown_session },
+        { "set_avatar",              10000,  setup_inventory, NULL,               op_set_avatar,       op_clear_avatar, teardown_session },
+        { "clear_avatar",            10000,  setup_inventory, op_set_avatar,      op_clear_avatar,     NULL,            teardown_session },
+        { "inventory_add",           10,     setup_inventory, NULL,               op_inventory_add,    op_inventory_remove, teardown_session },
+        { "inventory_add",           100,    setup_inventory, NULL,               op_inventory_add,    op_inventory_remove, teardown_session },
+        { "inventory_add",           1000,   setup_inventory, NULL,               op_inventory_add,    op_inventory_remove, teardown_session },
+        { "inventory_add",           10000,  setup_inventory, NULL,               op_inventory_add,    op_inventory_remove, teardown_session },
+        { "inventory_add",           100000, setup_inventory, NULL,               op_inventory_add,    op_inventory_remove, teardown_session },
+        { "inventory_remove_by_obj", 10,     setup_inventory, op_inventory_add,   op_inventory_remove, NULL,            teardown_session },
+        { "inventory_remove_by_obj", 100,    setup_inventory, op_inventory_add,   op_inventory_remove, NULL,            teardown_session },
+        { "inventory_remove_by_obj", 1000,   setup_inventory, op_inventory_add,   op_inventory_remove, NULL,            teardown_session },
+        { "inventory_remove_by_obj", 10000,  setup_inventory, op_inventory_add,   op_inventory_remove, NULL,            teardown_session },
+        { "inventory_remove_by_obj", 100000, setup_inventory, op_inventory_add,   op_inventory_remove, NULL,            teardown_session },
+        { "set_start_location_port", 0,      setup_session,   NULL,               op_start_port,       op_clear_start,  teardown_session },
+        { "set_start_location_name", 0,      setup_session,   NULL,               op_start_name,       op_clear_start,  teardown_session },
+        { "render_hex",              0,      setup_blacksun,  NULL,               op_render_hex,       NULL,            teardown_session },
+        { "render_ascii",            0,      setup_standard,  NULL,               op_render_ascii,     NULL,            teardown_session },
+        { "journal_record",          0,      setup_journal,   NULL,               op_journal_record,   NULL,            teardown_journal },
+    };
+
+    fprintf(json, "{\n  \"iterations\": %ld,\n  \"timer_overhead_ns\": %llu,\n  \"results\": [",
+            iters, (unsigned long long)timer_overhead_ns);
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++)
+        run(&benches[i], iters, samples, json, i == 0);
+    fprintf(json, "\n  ]\n}\n");
+
+    if (json != stdout) fclose(json);
+    fclose(devnull);
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,175 @@
+// metalogin_client.c - MetaLogin Avatar Manager
+// Load generator for metalogin_server: simulates many terminals at once.
+//
+// Opens N connections on one epoll loop. Each connection repeatedly runs a
+// login / start location / inventory / render / logout cycle, sending one
+// command at a time and waiting for the "Choice: " prompt that ends every
+// reply, then reports operations per second.
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CLIENT_DEFAULT_PATH   "/tmp/metalogin.sock"
+#define CLIENT_MAX_EVENTS     256
+#define CLIENT_CYCLE_OPS      6
+#define PROMPT                "Choice: "
+#define PROMPT_LEN            (sizeof(PROMPT) - 1)
+
+typedef struct term {
+    int       fd;
+    int       id;
+    long      iter;
+    int       step;             // next command in the cycle
+    size_t    matched;          // bytes of PROMPT matched so far
+    int       done;
+} term;
+
+static long iterations = 1000;
+
+static int format_cmd(const term *t, char *buf, size_t n) {
+    long obj = t->iter * 1000 + t->id;
+    switch (t->step) {
+        case 0: return snprintf(buf, n, "1 user%d code%d\n", t->id % 100000, t->id);
+        case 1: return snprintf(buf, n, "3 %ld\n", t->iter % 256);
+        case 2: return snprintf(buf, n, "5 %ld item%ld\n", obj, t->iter);
+        case 3: return snprintf(buf, n, "9\n");
+        case 4: return snprintf(buf, n, "6 %ld\n", obj);
+        default: return snprintf(buf, n, "2\n");
+    }
+}
+
+static int send_next(term *t) {
+    char buf[64];
+    int n = format_cmd(t, buf, sizeof(buf));
+    // Commands are tiny; a short write on a fresh reply boundary means the
+    // server is gone.
+    return write(t->fd, buf, (size_t)n) == n ? 0 : -1;
+}
+
+// Returns the number of prompts seen in buf.
+static int scan_prompts(term *t, const char *buf, size_t n) {
+    int prompts = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (buf[i] == PROMPT[t->matched]) {
+            if (++t->matched == PROMPT_LEN) {
+                prompts++;
+                t->matched = 0;
+            }
+        } else {
+            t->matched = buf[i] == PROMPT[0];
+        }
+    }
+    return prompts;
+}
+
+static int connect_unix(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-s socket_path] [-c connections] [-n iterations]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    const char *path = CLIENT_DEFAULT_PATH;
+    int nconns = 100;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:c:n:")) != -1) {
+        switch (opt) {
+            case 's': path = optarg; break;
+            case 'c': nconns = atoi(optarg); break;
+            case 'n': iterations = atol(optarg); break;
+            default: usage(argv[0]);
+        }
+    }
+    if (nconns < 1 || iterations < 1) usage(argv[0]);
+
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    term *terms = calloc((size_t)nconns, sizeof(*terms));
+    if (epfd < 0 || !terms) {
+        perror("setup");
+        return 1;
+    }
+    for (int i = 0; i < nconns; i++) {
+        terms[i].id = i;
+        terms[i].step = -1;     // waiting for the greeting prompt
+        terms[i].fd = connect_unix(path);
+        if (terms[i].fd < 0) {
+            perror(path);
+            return 1;
+        }
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &terms[i] };
+        epoll_ctl(epfd, EPOLL_CTL_ADD, terms[i].fd, &ev);
+    }
+
+    double t0 = now_sec();
+    long ops = 0;
+    int live = nconns;
+    char buf[8192];
+    struct epoll_event evs[CLIENT_MAX_EVENTS];
+    while (live > 0) {
+        int n = epoll_wait(epfd, evs, CLIENT_MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            return 1;
+        }
+        for (int i = 0; i < n; i++) {
+            term *t = evs[i].data.ptr;
+            ssize_t r;
+            int prompts = 0;
+            while ((r = read(t->fd, buf, sizeof(buf))) > 0)
+                prompts += scan_prompts(t, buf, (size_t)r);
+            if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                fprintf(stderr, "[CLIENT] terminal %d: server closed the connection\n", t->id);
+                return 1;
+            }
+            for (; prompts > 0 && !t->done; prompts--) {
+                if (t->step >= 0) ops++;
+                if (++t->step == CLIENT_CYCLE_OPS) {
+                    t->step = 0;
+                    if (++t->iter == iterations) {
+                        t->done = 1;
+                        epoll_ctl(epfd, EPOLL_CTL_DEL, t->fd, NULL);
+                        close(t->fd);
+                        live--;
+                        break;
+                    }
+                }
+                if (send_next(t) < 0) {
+                    fprintf(stderr, "[CLIENT] terminal %d: write failed\n", t->id);
+                    return 1;
+                }
+            }
+        }
+    }
+    double elapsed = now_sec() - t0;
+    printf("[CLIENT] %d terminals, %ld ops in %.3f s: %.0f ops/sec\n",
+           nconns, ops, elapsed, (double)ops / elapsed);
+    free(terms);
+    return 0;
+}
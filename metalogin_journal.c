@@ -0,0 +1,252 @@
+// metalogin_journal.c - MetaLogin Avatar Manager
+// Asynchronous audit journal (METALOGIN_JOURNAL=path).
+//
+// Every thread that records an event gets its own single-producer ring on
+// first use. Recording stamps the time from the coarse clock (one scheduler
+// tick of resolution, no TSC read), fills the next slot and publishes it with
+// one release store. It takes no lock and makes no system call. A writer thread polls the rings and copies
+// whatever is ready into a block that goes out with one write(). It sleeps
+// only when every ring is empty. When a ring is full the record is dropped
+// and counted; the writer logs the count as a JOURNAL_DROPPED record.
+#define _GNU_SOURCE
+#include "metalogin.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define JOURNAL_RING      16384     // records per thread, power of two
+#define JOURNAL_BATCH     1024      // records per write()
+#define JOURNAL_IDLE_NS   1000000
+
+typedef struct journal_ring {
+    // Producer side.
+    _Alignas(ML_CACHE_LINE) _Atomic uint64_t head;
+    uint64_t  tail_seen;        // last tail the producer read
+    atomic_int busy;            // inside journal_record; see journal_close
+    // Writer side.
+    _Alignas(ML_CACHE_LINE) _Atomic uint64_t tail;
+    _Atomic uint64_t dropped;
+    struct journal_ring *next;
+    uint16_t  id;
+    _Alignas(ML_CACHE_LINE) journal_rec recs[JOURNAL_RING];
+} journal_ring;
+
+atomic_int journal_enabled;
+
+static struct {
+    int       fd;
+    int       running;
+    int       write_failed;
+    _Atomic int stop;
+    pthread_t writer;
+    _Atomic(journal_ring *) rings;      // push-only list
+    atomic_uint nrings;
+} journal = { .fd = -1 };
+
+static _Thread_local journal_ring *my_ring;
+static journal_rec write_buf[JOURNAL_BATCH];    // writer thread, then journal_close
+
+#define RELAXED memory_order_relaxed
+
+// ============================================================================
+// PRODUCERS
+// ============================================================================
+// Rings are never freed: a worker may still be inside journal_record while
+// the process exits, and there is one ring per thread.
+static journal_ring *ring_register(void) {
+    journal_ring *r = aligned_alloc(ML_CACHE_LINE, sizeof(*r));
+    if (!r) return NULL;
+    memset(r, 0, offsetof(journal_ring, recs));
+    r->id = (uint16_t)atomic_fetch_add(&journal.nrings, 1);
+    journal_ring *head = atomic_load_explicit(&journal.rings, RELAXED);
+    do {
+        r->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&journal.rings, &head, r,
+                                                    memory_order_release, RELAXED));
+    return my_ring = r;
+}
+
+static uint64_t journal_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// busy is raised before journal_enabled is re-read (both seq_cst), so either
+// this call sees the journal closing and backs out, or journal_close sees
+// busy and waits for the record to be published before its final drain.
+void journal_record(session_h sess, int type, int result, long arg, const char *name) {
+    journal_ring *r = my_ring ? my_ring : ring_register();
+    if (!r) return;
+    atomic_store(&r->busy, 1);
+    if (!atomic_load(&journal_enabled)) goto out;
+    uint64_t head = atomic_load_explicit(&r->head, RELAXED);
+    if (head - r->tail_seen == JOURNAL_RING) {
+        r->tail_seen = atomic_load_explicit(&r->tail, memory_order_acquire);
+        if (head - r->tail_seen == JOURNAL_RING) {
+            atomic_fetch_add_explicit(&r->dropped, 1, RELAXED);
+            goto out;
+        }
+    }
+    journal_rec *e = &r->recs[head & (JOURNAL_RING - 1)];
+    e->time_ns = journal_now();
+    e->session = sess;
+    e->arg = arg;
+    e->type = (uint16_t)type;
+    e->ring = r->id;
+    e->result = result;
+    size_t len = name ? strnlen(name, MAX_LENGTH) : 0;
+    memcpy(e->name, name ? name : "", len);
+    memset(e->name + len, 0, MAX_LENGTH - len);
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+out:
+    atomic_store_explicit(&r->busy, 0, memory_order_release);
+}
+
+// ============================================================================
+// WRITER
+// ============================================================================
+static void journal_write(const journal_rec *recs, size_t n) {
+    const char *p = (const char *)recs;
+    size_t left = n * sizeof(*recs);
+    while (left) {
+        ssize_t w = write(journal.fd, p, left);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) {
+            if (!journal.write_failed)
+                fprintf(stderr, "[ERROR] Journal write failed: %s\n", strerror(errno));
+            journal.write_failed = 1;
+            return;
+        }
+        p += w;
+        left -= (size_t)w;
+    }
+}
+
+static void journal_flush(journal_rec *buf, size_t *n, size_t *total) {
+    journal_write(buf, *n);
+    *total += *n;
+    *n = 0;
+}
+
+// Moves everything published so far into the file; returns the record count.
+static size_t journal_drain(journal_rec *buf) {
+    size_t total = 0, n = 0;
+    journal_ring *r = atomic_load_explicit(&journal.rings, memory_order_acquire);
+    for (; r; r = r->next) {
+        uint64_t dropped = atomic_exchange_explicit(&r->dropped, 0, RELAXED);
+        if (dropped) {
+            if (n == JOURNAL_BATCH) journal_flush(buf, &n, &total);
+            buf[n++] = (journal_rec){
+                .time_ns = journal_now(),
+                .arg = (int64_t)dropped, .type = JOURNAL_DROPPED, .ring = r->id,
+            };
+        }
+        uint64_t tail = atomic_load_explicit(&r->tail, RELAXED);
+        uint64_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+        while (tail != head) {
+            if (n == JOURNAL_BATCH) journal_flush(buf, &n, &total);
+            size_t take = (size_t)(head - tail);
+            size_t idx = (size_t)(tail & (JOURNAL_RING - 1));
+            if (take > JOURNAL_RING - idx) take = JOURNAL_RING - idx;
+            if (take > JOURNAL_BATCH - n) take = JOURNAL_BATCH - n;
+            memcpy(&buf[n], &r->recs[idx], take * sizeof(*buf));
+            n += take;
+            tail += take;
+            atomic_store_explicit(&r->tail, tail, memory_order_release);
+        }
+    }
+    if (n) journal_flush(buf, &n, &total);
+    return total;
+}
+
+static void *journal_writer(void *arg) {
+    (void)arg;
+    for (;;) {
+        int stopping = atomic_load_explicit(&journal.stop, memory_order_acquire);
+        if (journal_drain(write_buf)) continue;
+        if (stopping) break;
+        struct timespec idle = { 0, JOURNAL_IDLE_NS };
+        nanosleep(&idle, NULL);
+    }
+    return NULL;
+}
+
+// ============================================================================
+// SETUP
+// ============================================================================
+// Appends to path, writing the header if the file is new. Returns 0 or -errno.
+int journal_open(const char *path) {
+    if (journal.running) return -EBUSY;
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) return -errno;
+    struct stat st;
+    int rc = 0;
+    if (fstat(fd, &st) < 0) {
+        rc = -errno;
+    } else if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        journal_header h;
+        int rfd = open(path, O_RDONLY | O_CLOEXEC);
+        if (rfd < 0 || read(rfd, &h, sizeof(h)) != (ssize_t)sizeof(h) ||
+            memcmp(h.magic, JOURNAL_MAGIC, sizeof(h.magic)) != 0 ||
+            h.version != JOURNAL_VERSION || h.record_size != sizeof(journal_rec))
+            rc = -EINVAL;
+        if (rfd >= 0) close(rfd);
+    } else {
+        journal_header h = { .version = JOURNAL_VERSION, .record_size = sizeof(journal_rec) };
+        memcpy(h.magic, JOURNAL_MAGIC, sizeof(h.magic));
+        if (write(fd, &h, sizeof(h)) != (ssize_t)sizeof(h))
+            rc = errno ? -errno : -EIO;
+    }
+    if (rc == 0) {
+        journal.fd = fd;
+        journal.write_failed = 0;
+        atomic_store(&journal.stop, 0);
+        rc = -pthread_create(&journal.writer, NULL, journal_writer, NULL);
+    }
+    if (rc < 0) {
+        close(fd);
+        journal.fd = -1;
+        return rc;
+    }
+    journal.running = 1;
+    atomic_store(&journal_enabled, 1);
+    return 0;
+}
+
+// Stops recording, waits for the writer to flush the rings and closes the file.
+// A producer that passed the journal_enabled check before it was cleared may
+// still be filling a slot, so wait for every ring to go idle and drain once
+// more after the writer has exited.
+void journal_close(void) {
+    if (!journal.running) return;
+    atomic_store(&journal_enabled, 0);
+    atomic_store_explicit(&journal.stop, 1, memory_order_release);
+    pthread_join(journal.writer, NULL);
+    journal_ring *r = atomic_load_explicit(&journal.rings, memory_order_acquire);
+    for (; r; r = r->next)
+        while (atomic_load_explicit(&r->busy, memory_order_acquire))
+            sched_yield();
+    journal_drain(write_buf);
+    close(journal.fd);
+    journal.fd = -1;
+    journal.running = 0;
+}
+
+void journal_init(void) {
+    static int done;
+    if (done) return;
+    done = 1;
+
+    const char *path = getenv("METALOGIN_JOURNAL");
+    if (!path) return;
+    int rc = journal_open(path);
+    if (rc < 0) {
+        fprintf(stderr, "[ERROR] Could not open journal %s: %s\n", path, strerror(-rc));
+        return;
+    }
+    atexit(journal_close);
+}
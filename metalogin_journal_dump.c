@@ -0,0 +1,101 @@
+// metalogin_journal_dump.c - MetaLogin Avatar Manager
+// Prints an audit journal (see metalogin_journal.c) as text, one line per
+// record:
+//
+//   METALOGIN_JOURNAL=audit.log ./metalogin_server &
+//   ./metalogin_journal_dump audit.log
+//
+//   2026-10-17T19:31:13.123456789Z ring 0 session 0000000100000001 login hiro_p granted
+#define _GNU_SOURCE
+#include "metalogin.h"
+
+#include <time.h>
+
+#define DUMP_BATCH 4096
+
+static void print_name(const char *name) {
+    for (size_t i = 0; i < MAX_LENGTH && name[i]; i++) {
+        unsigned char c = (unsigned char)name[i];
+        if (c < 0x20 || c > 0x7e) printf("\\x%02x", c);
+        else putchar(c);
+    }
+}
+
+static void print_rec(const journal_rec *r) {
+    time_t sec = (time_t)(r->time_ns / 1000000000ull);
+    struct tm tm;
+    char when[32];
+    gmtime_r(&sec, &tm);
+    strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%S", &tm);
+    printf("%s.%09lluZ ring %u session %016llx ", when,
+           (unsigned long long)(r->time_ns % 1000000000ull), r->ring,
+           (unsigned long long)r->session);
+    switch (r->type) {
+        case JOURNAL_LOGIN:
+            printf("login ");
+            print_name(r->name);
+            printf(" %s", r->result == 1 ? "granted" : r->result == -1 ? "denied" : "user");
+            break;
+        case JOURNAL_LOGOUT:
+            printf("logout ");
+            print_name(r->name);
+            break;
+        case JOURNAL_START_LOC:
+            printf("start_loc ");
+            print_name(r->name);
+            break;
+        case JOURNAL_START_LOC_CLEAR:
+            printf("start_loc_clear");
+            break;
+        case JOURNAL_ITEM_ADD:
+            printf("item_add %lld ", (long long)r->arg);
+            print_name(r->name);
+            break;
+        case JOURNAL_ITEM_REMOVE:
+            printf("item_remove %lld %s", (long long)r->arg,
+                   r->result > 0 ? "removed" : r->result == 0 ? "not_found" : "error");
+            break;
+        case JOURNAL_ITEM_CLEAR:
+            printf("item_clear");
+            break;
+        case JOURNAL_ITEM_IMPORT:
+            printf("item_import %lld", (long long)r->arg);
+            if (r->result < 0) printf(" failed: %s", strerror(-r->result));
+            break;
+        case JOURNAL_DROPPED:
+            printf("dropped %lld", (long long)r->arg);
+            break;
+        default:
+            printf("unknown type %u", r->type);
+    }
+    putchar('\n');
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s journal\n", argv[0]);
+        return 2;
+    }
+    FILE *f = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+    journal_header h;
+    if (fread(&h, sizeof(h), 1, f) != 1 || memcmp(h.magic, JOURNAL_MAGIC, sizeof(h.magic)) != 0 ||
+        h.version != JOURNAL_VERSION || h.record_size != sizeof(journal_rec)) {
+        fprintf(stderr, "[ERROR] %s is not a version %d journal\n", argv[1], JOURNAL_VERSION);
+        return 1;
+    }
+    static journal_rec recs[DUMP_BATCH];
+    size_t n;
+    while ((n = fread(recs, sizeof(journal_rec), DUMP_BATCH, f)) > 0) {
+        for (size_t i = 0; i < n; i++)
+            print_rec(&recs[i]);
+    }
+    if (ferror(f)) {
+        perror(argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,353 @@
+// metalogin_server.c - MetaLogin Avatar Manager
+// Unix domain socket front end: many terminals served from one process.
+//
+// Every connection gets its own session. Worker threads each run an epoll
+// loop and share the listening socket (EPOLLEXCLUSIVE), so a connection is
+// accepted and then driven by exactly one worker. Each line a client sends
+// is one menu operation in the metalogin_dispatch format; the reply is the
+// operation's output followed by the "Choice: " prompt.
+#define _GNU_SOURCE
+#include "metalogin.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SERVER_DEFAULT_PATH     "/tmp/metalogin.sock"
+#define SERVER_DEFAULT_WORKERS  4
+#define SERVER_MAX_WORKERS      64
+#define SERVER_MAX_EVENTS       64
+#define CONN_LINE_MAX           256
+#define CONN_OUT_MIN            4096
+#define CONN_OUT_HIGH           (256 * 1024)    // unsent bytes before reading pauses
+#define CONN_LINES_PER_WAKEUP   64
+#define PROMPT                  "Choice: "
+
+typedef struct conn {
+    int       fd;
+    session_h sess;
+    FILE      *out;             // session output, appends to obuf
+    char      in[CONN_LINE_MAX];
+    size_t    in_len;
+    int       discarding;       // dropping an over-long line up to its '\n'
+    int       eof;              // the peer is done sending; buffered lines still run
+    int       closing;          // close once obuf has drained
+    uint32_t  events;           // epoll events currently armed
+    char      *obuf;
+    size_t    olen;
+    size_t    ooff;
+    size_t    ocap;
+} conn;
+
+typedef struct worker {
+    pthread_t thread;
+    int       epfd;
+    int       listen_fd;
+} worker;
+
+// ============================================================================
+// CONNECTION OUTPUT
+// ============================================================================
+static ssize_t conn_out_write(void *cookie, const char *buf, size_t size) {
+    conn *c = cookie;
+    if (c->olen + size > c->ocap && c->ooff) {
+        memmove(c->obuf, c->obuf + c->ooff, c->olen - c->ooff);
+        c->olen -= c->ooff;
+        c->ooff = 0;
+    }
+    if (c->olen + size > c->ocap) {
+        size_t cap = c->ocap ? c->ocap : CONN_OUT_MIN;
+        while (c->olen + size > cap) cap *= 2;
+        char *p = realloc(c->obuf, cap);
+        if (!p) return -1;
+        c->obuf = p;
+        c->ocap = cap;
+    }
+    memcpy(c->obuf + c->olen, buf, size);
+    c->olen += size;
+    return (ssize_t)size;
+}
+
+static size_t conn_backlog(const conn *c) {
+    return c->olen - c->ooff;
+}
+
+// A complete line is waiting in the input buffer.
+static int conn_has_line(const conn *c) {
+    return !c->closing && memchr(c->in, '\n', c->in_len) != NULL;
+}
+
+// Reading pauses while more than CONN_OUT_HIGH bytes are waiting for the
+// client, and EPOLLOUT resumes it once they drain. EPOLLOUT also brings a
+// connection back for lines a capped wakeup left in its input buffer.
+static void conn_set_events(worker *w, conn *c) {
+    uint32_t events = 0;
+    if (!c->eof && !c->closing && conn_backlog(c) <= CONN_OUT_HIGH)
+        events |= EPOLLIN | EPOLLRDHUP;
+    if (conn_backlog(c) || conn_has_line(c))
+        events |= EPOLLOUT;
+    if (events == c->events) return;
+    struct epoll_event ev = { .events = events, .data.ptr = c };
+    epoll_ctl(w->epfd, EPOLL_CTL_MOD, c->fd, &ev);
+    c->events = events;
+}
+
+// Returns -1 when the peer is gone.
+static int conn_flush(conn *c) {
+    fflush(c->out);
+    while (c->ooff < c->olen) {
+        ssize_t n = write(c->fd, c->obuf + c->ooff, c->olen - c->ooff);
+        if (n > 0) {
+            c->ooff += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        } else {
+            return -1;
+        }
+    }
+    c->olen = c->ooff = 0;
+    return 0;
+}
+
+// ============================================================================
+// CONNECTION LIFECYCLE
+// ============================================================================
+static void conn_close(worker *w, conn *c) {
+    epoll_ctl(w->epfd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    session_close(c->sess);
+    fclose(c->out);
+    free(c->obuf);
+    free(c);
+}
+
+static conn *conn_open(int fd) {
+    static const cookie_io_functions_t conn_io = { .write = conn_out_write };
+    conn *c = calloc(1, sizeof(*c));
+    if (!c) return NULL;
+    c->fd = fd;
+    c->sess = session_open();
+    c->out = fopencookie(c, "w", conn_io);
+    if (!c->sess || !c->out) {
+        if (c->out) fclose(c->out);
+        session_close(c->sess);
+        free(c);
+        return NULL;
+    }
+    setvbuf(c->out, NULL, _IOFBF, BUFSIZ);
+    session_get(c->sess)->out = c->out;
+    return c;
+}
+
+static void accept_all(worker *w) {
+    for (;;) {
+        int fd = accept4(w->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;     // EAGAIN, or another worker got there first
+        }
+        conn *c = conn_open(fd);
+        if (!c) {
+            close(fd);
+            continue;
+        }
+        c->events = EPOLLIN | EPOLLRDHUP;
+        struct epoll_event ev = { .events = c->events, .data.ptr = c };
+        if (epoll_ctl(w->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            conn_close(w, c);
+            continue;
+        }
+        fputs(PROMPT, c->out);
+        if (conn_flush(c) < 0)
+            conn_close(w, c);
+        else
+            conn_set_events(w, c);
+    }
+}
+
+// ============================================================================
+// REQUEST HANDLING
+// ============================================================================
+// Runs up to max complete lines from the input buffer, stopping early once
+// the output backlog passes CONN_OUT_HIGH. Returns the number of lines run.
+static int conn_run_lines(conn *c, int max) {
+    size_t pos = 0, line = 0;
+    int ran = 0;
+    for (; pos < c->in_len && ran < max && conn_backlog(c) <= CONN_OUT_HIGH; pos++) {
+        if (c->in[pos] != '\n') continue;
+        c->in[pos] = '\0';
+        if (c->discarding) {
+            c->discarding = 0;
+        } else if (!c->closing) {
+            if (metalogin_dispatch(c->sess, c->in + line) == 1)
+                c->closing = 1;
+            else
+                fputs(PROMPT, c->out);
+        }
+        line = pos + 1;
+        ran++;
+    }
+    memmove(c->in, c->in + line, c->in_len - line);
+    c->in_len -= line;
+    if (c->in_len == sizeof(c->in) && !memchr(c->in, '\n', c->in_len)) {
+        // No newline in a full buffer: reject the line and skip the rest of it.
+        if (!c->discarding)
+            fprintf(c->out, "[ERROR] Line too long\n" PROMPT);
+        c->in_len = 0;
+        c->discarding = 1;
+    }
+    return ran;
+}
+
+// One wakeup: runs buffered lines and reads more, at most
+// CONN_LINES_PER_WAKEUP of them, so one busy client cannot starve the
+// others on its worker. After EOF the lines already received still run, and
+// the connection closes once their output has drained.
+static void conn_service(worker *w, conn *c) {
+    int budget = CONN_LINES_PER_WAKEUP;
+    budget -= conn_run_lines(c, budget);
+    while (budget > 0 && !c->eof && !c->closing && conn_backlog(c) <= CONN_OUT_HIGH) {
+        ssize_t n = read(c->fd, c->in + c->in_len, sizeof(c->in) - c->in_len);
+        if (n > 0) {
+            c->in_len += (size_t)n;
+            budget -= conn_run_lines(c, budget);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        c->eof = 1;         // EOF or error
+    }
+    if (c->eof && !conn_has_line(c))
+        c->closing = 1;
+    if (conn_flush(c) < 0 || (c->closing && !conn_backlog(c))) {
+        conn_close(w, c);
+        return;
+    }
+    conn_set_events(w, c);
+}
+
+static void *worker_main(void *arg) {
+    worker *w = arg;
+    struct epoll_event evs[SERVER_MAX_EVENTS];
+    for (;;) {
+        int n = epoll_wait(w->epfd, evs, SERVER_MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            return NULL;
+        }
+        for (int i = 0; i < n; i++) {
+            conn *c = evs[i].data.ptr;
+            // A hangup is handled like EOF: reading comes first, so lines
+            // the peer sent before closing still run.
+            if (!c)
+                accept_all(w);
+            else
+                conn_service(w, c);
+        }
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+static int listen_unix(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "[ERROR] Socket path too long: %s\n", path);
+        return -1;
+    }
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-s socket_path] [-w workers] [-d blacksun_directory]\n", argv0);
+    exit(2);
+}
+
+static void load_directory(const char *path) {
+    int n = blacksun_load(path);
+    if (n < 0)
+        fprintf(stderr, "[ERROR] Could not load Black Sun directory %s: %s\n", path, strerror(-n));
+    else
+        printf("[SERVER] Loaded %d Black Sun members from %s\n", n, path);
+}
+
+int main(int argc, char **argv) {
+    const char *path = SERVER_DEFAULT_PATH;
+    const char *directory = NULL;
+    int nworkers = SERVER_DEFAULT_WORKERS;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:w:d:")) != -1) {
+        switch (opt) {
+            case 's': path = optarg; break;
+            case 'w': nworkers = atoi(optarg); break;
+            case 'd': directory = optarg; break;
+            default: usage(argv[0]);
+        }
+    }
+    if (nworkers < 1 || nworkers > SERVER_MAX_WORKERS) usage(argv[0]);
+
+    signal(SIGPIPE, SIG_IGN);
+    init_system();
+    if (directory) load_directory(directory);
+
+    // Workers inherit a mask with these signals blocked; the main thread
+    // waits for them. SIGHUP hot-reloads the directory while logins keep
+    // running; SIGINT/SIGTERM exit normally so exit handlers (stats) run.
+    sigset_t sigs;
+    sigemptyset(&sigs);
+    sigaddset(&sigs, SIGHUP);
+    sigaddset(&sigs, SIGINT);
+    sigaddset(&sigs, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &sigs, NULL);
+
+    int listen_fd = listen_unix(path);
+    if (listen_fd < 0) return 1;
+
+    static worker workers[SERVER_MAX_WORKERS];
+    for (int i = 0; i < nworkers; i++) {
+        worker *w = &workers[i];
+        w->listen_fd = listen_fd;
+        w->epfd = epoll_create1(EPOLL_CLOEXEC);
+        struct epoll_event ev = { .events = EPOLLIN | EPOLLEXCLUSIVE, .data.ptr = NULL };
+        if (w->epfd < 0 || epoll_ctl(w->epfd, EPOLL_CTL_ADD, listen_fd, &ev) < 0) {
+            perror("epoll");
+            return 1;
+        }
+        if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+            fprintf(stderr, "[ERROR] Could not start worker %d\n", i);
+            return 1;
+        }
+    }
+    printf("[SERVER] Listening on %s with %d workers\n", path, nworkers);
+    fflush(stdout);
+    for (;;) {
+        int sig;
+        if (sigwait(&sigs, &sig) != 0) continue;
+        if (sig != SIGHUP) break;
+        if (directory) load_directory(directory);
+        fflush(stdout);
+    }
+    printf("[SERVER] Shutting down\n");
+    unlink(path);
+    exit(0);
+}
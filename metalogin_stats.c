@@ -0,0 +1,185 @@
+// metalogin_stats.c - MetaLogin Avatar Manager
+// Opt-in instrumentation (-DMETALOGIN_STATS): heap traffic per call site,
+// live bytes per object type, and cycle timers per menu operation.
+//
+// Counters live in one fixed-layout page. It starts out in static storage.
+// If METALOGIN_STATS_SHM names a POSIX shared memory object, ml_stats_init
+// moves the page there so metalogin_stats_dump can read it live. At exit the
+// page is written as JSON to METALOGIN_STATS_JSON, or to stderr when that
+// variable is unset. All updates are relaxed atomics, so the server's worker
+// threads can share the page.
+#define _GNU_SOURCE
+#include "metalogin.h"
+
+#ifdef METALOGIN_STATS
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static const char *const ml_stat_type_names[ML_STAT_TYPES] = {
+    "avatar", "item", "start_loc", "string", "inventory", "session", "render"
+};
+
+static ml_stats_page ml_stats_static = { .magic = ML_STATS_MAGIC, .version = ML_STATS_VERSION };
+ml_stats_page *ml_stats = &ml_stats_static;
+static pthread_mutex_t ml_stats_site_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#define RELAXED memory_order_relaxed
+
+// ============================================================================
+// COUNTERS
+// ============================================================================
+uint64_t ml_stats_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static void atomic_max_u64(_Atomic uint64_t *p, uint64_t v) {
+    uint64_t cur = atomic_load_explicit(p, RELAXED);
+    while (v > cur && !atomic_compare_exchange_weak_explicit(p, &cur, v, RELAXED, RELAXED))
+        ;
+}
+
+// count > 0 records allocations, count < 0 frees; bytes is the matching total.
+void ml_stats_object(int type, int64_t count, int64_t bytes) {
+    if (type < 0 || type >= ML_STAT_TYPES) return;
+    ml_type_stats *t = &ml_stats->types[type];
+    if (count > 0)
+        atomic_fetch_add_explicit(&t->allocs, (uint64_t)count, RELAXED);
+    else
+        atomic_fetch_add_explicit(&t->frees, (uint64_t)-count, RELAXED);
+    int64_t now = atomic_fetch_add_explicit(&t->bytes_in_use, bytes, RELAXED) + bytes;
+    int64_t peak = atomic_load_explicit(&t->peak_bytes, RELAXED);
+    while (now > peak &&
+           !atomic_compare_exchange_weak_explicit(&t->peak_bytes, &peak, now, RELAXED, RELAXED))
+        ;
+}
+
+// *site caches the call site's slot (index + 1); the first call registers it.
+void ml_stats_heap(_Atomic uint32_t *site, const char *func, int line,
+                   const char *call, size_t bytes) {
+    uint32_t idx = atomic_load_explicit(site, memory_order_acquire);
+    if (!idx) {
+        pthread_mutex_lock(&ml_stats_site_lock);
+        idx = atomic_load_explicit(site, RELAXED);
+        uint32_t n = atomic_load_explicit(&ml_stats->nsites, RELAXED);
+        if (!idx && n < ML_STATS_MAX_SITES) {
+            snprintf(ml_stats->sites[n].where, sizeof(ml_stats->sites[n].where),
+                     "%s:%d %s", func, line, call);
+            atomic_store_explicit(&ml_stats->nsites, n + 1, memory_order_release);
+            idx = n + 1;
+            atomic_store_explicit(site, idx, memory_order_release);
+        }
+        pthread_mutex_unlock(&ml_stats_site_lock);
+        if (!idx) return;       // table full
+    }
+    ml_site_stats *s = &ml_stats->sites[idx - 1];
+    atomic_fetch_add_explicit(&s->calls, 1, RELAXED);
+    atomic_fetch_add_explicit(&s->bytes, bytes, RELAXED);
+}
+
+void ml_stats_op(int choice, uint64_t cycles) {
+    if (choice < 0 || choice >= ML_STATS_OPS) return;
+    ml_op_stats *op = &ml_stats->ops[choice];
+    atomic_fetch_add_explicit(&op->count, 1, RELAXED);
+    atomic_fetch_add_explicit(&op->cycles, cycles, RELAXED);
+    atomic_max_u64(&op->max_cycles, cycles);
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+static void json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(out, "\\%c", c);
+        else if (c < 0x20) fprintf(out, "\\u%04x", c);
+        else fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+void ml_stats_write_json(FILE *out, const ml_stats_page *pg) {
+    fprintf(out, "{\n  \"types\": {");
+    for (int i = 0; i < ML_STAT_TYPES; i++) {
+        const ml_type_stats *t = &pg->types[i];
+        fprintf(out, "%s\n    \"%s\": {\"allocs\": %llu, \"frees\": %llu, "
+                     "\"bytes_in_use\": %lld, \"peak_bytes\": %lld}",
+                i ? "," : "", ml_stat_type_names[i],
+                (unsigned long long)atomic_load_explicit(&t->allocs, RELAXED),
+                (unsigned long long)atomic_load_explicit(&t->frees, RELAXED),
+                (long long)atomic_load_explicit(&t->bytes_in_use, RELAXED),
+                (long long)atomic_load_explicit(&t->peak_bytes, RELAXED));
+    }
+    fprintf(out, "\n  },\n  \"ops\": {");
+    int first = 1;
+    for (int i = 0; i < ML_STATS_OPS; i++) {
+        const ml_op_stats *op = &pg->ops[i];
+        uint64_t count = atomic_load_explicit(&op->count, RELAXED);
+        if (!count) continue;
+        uint64_t cycles = atomic_load_explicit(&op->cycles, RELAXED);
+        fprintf(out, "%s\n    \"%d\": {\"count\": %llu, \"cycles\": %llu, "
+                     "\"mean_cycles\": %.1f, \"max_cycles\": %llu}",
+                first ? "" : ",", i, (unsigned long long)count, (unsigned long long)cycles,
+                (double)cycles / (double)count,
+                (unsigned long long)atomic_load_explicit(&op->max_cycles, RELAXED));
+        first = 0;
+    }
+    fprintf(out, "\n  },\n  \"sites\": [");
+    uint32_t n = atomic_load_explicit(&pg->nsites, memory_order_acquire);
+    if (n > ML_STATS_MAX_SITES) n = ML_STATS_MAX_SITES;
+    for (uint32_t i = 0; i < n; i++) {
+        const ml_site_stats *s = &pg->sites[i];
+        fprintf(out, "%s\n    {\"site\": ", i ? "," : "");
+        json_string(out, s->where);
+        fprintf(out, ", \"calls\": %llu, \"bytes\": %llu}",
+                (unsigned long long)atomic_load_explicit(&s->calls, RELAXED),
+                (unsigned long long)atomic_load_explicit(&s->bytes, RELAXED));
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+static void ml_stats_dump_at_exit(void) {
+    const char *path = getenv("METALOGIN_STATS_JSON");
+    FILE *out = path ? fopen(path, "w") : stderr;
+    if (!out) {
+        perror(path);
+        return;
+    }
+    ml_stats_write_json(out, ml_stats);
+    if (out != stderr) fclose(out);
+}
+
+// Moves the page into shared memory if requested and arranges the exit dump.
+void ml_stats_init(void) {
+    static int done;
+    if (done) return;
+    done = 1;
+
+    const char *shm = getenv("METALOGIN_STATS_SHM");
+    if (shm) {
+        int fd = shm_open(shm, O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+        void *p = MAP_FAILED;
+        if (fd >= 0 && ftruncate(fd, sizeof(ml_stats_page)) == 0)
+            p = mmap(NULL, sizeof(ml_stats_page), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (fd >= 0) close(fd);
+        if (p == MAP_FAILED) {
+            fprintf(stderr, "[ERROR] Could not map stats page %s: %s\n", shm, strerror(errno));
+        } else {
+            memcpy(p, &ml_stats_static, sizeof(ml_stats_page));
+            ml_stats = p;
+        }
+    }
+    atexit(ml_stats_dump_at_exit);
+}
+#endif
@@ -0,0 +1,38 @@
+// metalogin_stats_dump.c - MetaLogin Avatar Manager
+// Prints the live stats page of a running METALOGIN_STATS build as JSON.
+//
+//   METALOGIN_STATS_SHM=/metalogin-stats ./metalogin_server &
+//   ./metalogin_stats_dump /metalogin-stats
+#define _GNU_SOURCE
+#include "metalogin.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#ifndef METALOGIN_STATS
+#error "build with -DMETALOGIN_STATS"
+#endif
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s shm_name\n", argv[0]);
+        return 2;
+    }
+    int fd = shm_open(argv[1], O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    const ml_stats_page *pg = mmap(NULL, sizeof(*pg), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pg == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    if (pg->magic != ML_STATS_MAGIC || pg->version != ML_STATS_VERSION) {
+        fprintf(stderr, "[ERROR] %s is not a version %d stats page\n", argv[1], ML_STATS_VERSION);
+        return 1;
+    }
+    ml_stats_write_json(stdout, pg);
+    return 0;
+}
@@ -0,0 +1,39 @@
+// port_gen.c - MetaLogin Avatar Manager
+// Emits the Street port catalog (name and ring coordinates per port) for globals.c.
+//
+// Port i sits at angle 2*pi*i/256 on a ring with a 65536-unit circumference.
+// Coordinates are 16.16 fixed point, biased by 0x80000000 and stored
+// big-endian.
+#include "metalogin.h"
+
+#include <math.h>
+
+static void be_store_u32(uint8_t out[4], uint32_t v) {
+    out[0] = (uint8_t)((v >> 24) & 0xFF);
+    out[1] = (uint8_t)((v >> 16) & 0xFF);
+    out[2] = (uint8_t)((v >>  8) & 0xFF);
+    out[3] = (uint8_t)( v        & 0xFF);
+}
+
+int main(void) {
+    const double C = 65536.0;
+    const double R = C / (2.0 * M_PI);
+    const double SCALE = 65536.0;
+
+    printf("// Generated by port_gen - do not edit.\n");
+    printf("const port_entry port_catalog[NUM_PORTS] = {\n");
+    for (int i = 0; i < NUM_PORTS; i++) {
+        const double theta = (2.0 * M_PI) * ((double)i / 256.0);
+        int32_t fx = (int32_t)llround(R * cos(theta) * SCALE);
+        int32_t fy = (int32_t)llround(R * sin(theta) * SCALE);
+        uint8_t c[8];
+        be_store_u32(&c[0], (uint32_t)fx + 0x80000000u);
+        be_store_u32(&c[4], (uint32_t)fy + 0x80000000u);
+        printf("    { \"%d\", {", i);
+        for (int k = 0; k < 8; k++)
+            printf("%s0x%02X", k ? ", " : " ", c[k]);
+        printf(" } },\n");
+    }
+    printf("};\n");
+    return 0;
+}
@@ -0,0 +1,347 @@
+// replay_wmi2.c - MetaLogin Avatar Manager
+// Native replay of KLEE test cases for the WMI-2 driver:
+//
+//   ./build_replay.sh
+//   ./replay_wmi2 klee-out-0                      # every test*.ktest in it
+//   ./replay_wmi2 klee-par/merged/test000003.ktest
+//
+// Each test runs wmi2_leak_sequence (driver_wmi2_leak.c) on the test's
+// username, access_code and stdin line, against metalogin.c built with
+// METALOGIN_SYSTEM_ALLOC, so a stale avatar points into the real glibc heap.
+// A fork server pays for init_system once: the parent initializes and then
+// forks one child per test, which starts from that state, replays and exits.
+// One line per test:
+//
+//   leak     the stale avatar's username bytes hold a heap address
+//   stale    the session still points at the freed avatar, no address in it
+//   clean    the session holds no avatar
+//   invalid  the inputs break the driver's assumptions, or the file is bad
+//   crash    the replay died on a signal
+//
+// -v keeps the program's own output. Exits 1 if any test leaked or crashed.
+#define _GNU_SOURCE
+#include "metalogin.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+
+enum { REPLAY_CLEAN, REPLAY_STALE, REPLAY_LEAK, REPLAY_INVALID, REPLAY_CRASH, REPLAY_KINDS };
+
+static const char *replay_names[REPLAY_KINDS] = { "clean", "stale", "leak", "invalid", "crash" };
+
+// A child exits with REPLAY_EXIT + its result; any other status (a sanitizer
+// report, say) counts as a crash.
+#define REPLAY_EXIT 64
+
+// ============================================================================
+// KTEST FILES
+// ============================================================================
+// KLEE's format: "KTEST", a version, the argv, then named objects. Every
+// integer is a big-endian uint32.
+typedef struct ktest_obj {
+    const char *name;           // name_len bytes, not terminated
+    uint32_t  name_len;
+    const unsigned char *bytes;
+    uint32_t  len;
+} ktest_obj;
+
+typedef struct ktest {
+    unsigned char *data;
+    ktest_obj *objs;
+    uint32_t  nobjs;
+} ktest;
+
+typedef struct ktest_cursor {
+    const unsigned char *p;
+    const unsigned char *end;
+} ktest_cursor;
+
+static int kt_u32(ktest_cursor *c, uint32_t *out) {
+    if (c->end - c->p < 4) return -1;
+    *out = (uint32_t)c->p[0] << 24 | (uint32_t)c->p[1] << 16 | (uint32_t)c->p[2] << 8 | c->p[3];
+    c->p += 4;
+    return 0;
+}
+
+static int kt_bytes(ktest_cursor *c, uint32_t len, const unsigned char **out) {
+    if ((size_t)(c->end - c->p) < len) return -1;
+    *out = c->p;
+    c->p += len;
+    return 0;
+}
+
+static void ktest_free(ktest *kt) {
+    free(kt->objs);
+    free(kt->data);
+    memset(kt, 0, sizeof(*kt));
+}
+
+// Returns 0, -errno, or -EINVAL for a file that is not a ktest.
+static int ktest_load(const char *path, ktest *kt) {
+    memset(kt, 0, sizeof(*kt));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -errno;
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int rc = -errno;
+        close(fd);
+        return rc;
+    }
+    size_t size = (size_t)st.st_size;
+    kt->data = malloc(size ? size : 1);
+    if (!kt->data) {
+        printf("[ERROR] Memory allocation failed\n");
+        exit(1);
+    }
+    size_t got = 0;
+    while (got < size) {
+        ssize_t r = read(fd, kt->data + got, size - got);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) {
+            int rc = r < 0 ? -errno : -EINVAL;
+            close(fd);
+            ktest_free(kt);
+            return rc;
+        }
+        got += (size_t)r;
+    }
+    close(fd);
+
+    ktest_cursor c = { kt->data, kt->data + size };
+    const unsigned char *magic;
+    uint32_t version, nargs, len, skip;
+    if (kt_bytes(&c, 5, &magic) < 0 || memcmp(magic, "KTEST", 5) != 0 ||
+        kt_u32(&c, &version) < 0 || version < 1 || version > 3 || kt_u32(&c, &nargs) < 0)
+        goto bad;
+    for (uint32_t i = 0; i < nargs; i++) {
+        const unsigned char *arg;
+        if (kt_u32(&c, &len) < 0 || kt_bytes(&c, len, &arg) < 0) goto bad;
+    }
+    if (version >= 2 && (kt_u32(&c, &skip) < 0 || kt_u32(&c, &skip) < 0))
+        goto bad;       // sym_argvs, sym_argv_len
+    if (kt_u32(&c, &kt->nobjs) < 0 || kt->nobjs > size / 8) goto bad;
+    kt->objs = calloc(kt->nobjs ? kt->nobjs : 1, sizeof(ktest_obj));
+    if (!kt->objs) {
+        printf("[ERROR] Memory allocation failed\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < kt->nobjs; i++) {
+        ktest_obj *o = &kt->objs[i];
+        const unsigned char *name;
+        if (kt_u32(&c, &o->name_len) < 0 || kt_bytes(&c, o->name_len, &name) < 0 ||
+            kt_u32(&c, &o->len) < 0 || kt_bytes(&c, o->len, &o->bytes) < 0)
+            goto bad;
+        o->name = (const char *)name;
+    }
+    return 0;
+bad:
+    ktest_free(kt);
+    return -EINVAL;
+}
+
+static const ktest_obj *ktest_find(const ktest *kt, const char *name) {
+    size_t n = strlen(name);
+    for (uint32_t i = 0; i < kt->nobjs; i++) {
+        if (kt->objs[i].name_len == n && memcmp(kt->objs[i].name, name, n) == 0)
+            return &kt->objs[i];
+    }
+    return NULL;
+}
+
+// Copies an object into a NUL-terminated MAX_LENGTH buffer, as the driver
+// terminates its symbolic buffers.
+static void ktest_string(const ktest *kt, const char *name, char out[MAX_LENGTH]) {
+    const ktest_obj *o = ktest_find(kt, name);
+    memset(out, 0, MAX_LENGTH);
+    if (o) memcpy(out, o->bytes, o->len < MAX_LENGTH ? o->len : MAX_LENGTH);
+    out[MAX_LENGTH - 1] = '\0';
+}
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+// glibc's main arena: the [heap] mapping of this process.
+static int heap_range(uintptr_t *lo, uintptr_t *hi) {
+    FILE *f = fopen("/proc/self/maps", "r");
+    if (!f) return -1;
+    char line[512];
+    int rc = -1;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long a, b;
+        if (strstr(line, "[heap]") && sscanf(line, "%lx-%lx", &a, &b) == 2) {
+            *lo = a;
+            *hi = b;
+            rc = 0;
+            break;
+        }
+    }
+    fclose(f);
+    return rc;
+}
+
+static uintptr_t heap_lo, heap_hi;
+
+// wmi2_leaks' heap test.
+static int in_heap(uintptr_t v) {
+    return v >= heap_lo && v < heap_hi;
+}
+
+// Runs in the forked child; returns its REPLAY_* result.
+static int replay_one(const char *path, const ktest *kt, FILE *out) {
+    char username[MAX_LENGTH], access_code[MAX_LENGTH];
+    ktest_string(kt, "username", username);
+    ktest_string(kt, "access_code", access_code);
+    if (!username[0]) {
+        printf("%s: invalid (empty username)\n", path);
+        return REPLAY_INVALID;
+    }
+
+    // set_start_location reads its line from stdin: the symbolic stdin
+    // model's object if the test has one, else the fixed stub's "127".
+    char line[MAX_LENGTH + 1];
+    ktest_string(kt, "stdin", line);
+    if (!ktest_find(kt, "stdin")) strcpy(line, "127");
+    size_t n = strlen(line);
+    line[n++] = '\n';
+    int fds[2];
+    if (pipe(fds) < 0 || write(fds[1], line, n) != (ssize_t)n || dup2(fds[0], STDIN_FILENO) < 0) {
+        perror("stdin");
+        return REPLAY_INVALID;
+    }
+    close(fds[0]);
+    close(fds[1]);
+
+    session_h sess = session_open();
+    session_get(sess)->out = out;
+    avatar *av = wmi2_leak_sequence(sess, username, access_code);
+    if (!av) {
+        printf("%s: clean\n", path);
+        return REPLAY_CLEAN;
+    }
+    uintptr_t leaked;
+    if (heap_range(&heap_lo, &heap_hi) < 0) heap_lo = heap_hi = 0;
+    if (wmi2_leaks(av, in_heap, &leaked)) {
+        printf("%s: leak avatar %p username bytes 0x%016lx in heap [0x%lx, 0x%lx)\n",
+               path, (void *)av, (unsigned long)leaked, (unsigned long)heap_lo, (unsigned long)heap_hi);
+        return REPLAY_LEAK;
+    }
+    printf("%s: stale avatar %p username bytes 0x%016lx\n", path, (void *)av, (unsigned long)leaked);
+    return REPLAY_STALE;
+}
+
+static int is_ktest(const struct dirent *d) {
+    size_t n = strlen(d->d_name);
+    return strncmp(d->d_name, "test", 4) == 0 && n > 6 && strcmp(d->d_name + n - 6, ".ktest") == 0;
+}
+
+// Appends path, or the test*.ktest files in it if it is a directory.
+static void collect(const char *path, char ***paths, size_t *n, size_t *cap) {
+    struct stat st;
+    struct dirent **ents = NULL;
+    int nents = -1;
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode))
+        nents = scandir(path, &ents, is_ktest, alphasort);
+    for (int i = 0; i < (nents < 0 ? 1 : nents); i++) {
+        if (*n == *cap) {
+            *cap = *cap ? *cap * 2 : 64;
+            *paths = realloc(*paths, *cap * sizeof(**paths));
+            if (!*paths) {
+                printf("[ERROR] Memory allocation failed\n");
+                exit(1);
+            }
+        }
+        char *p;
+        if (nents < 0) {
+            p = strdup(path);
+        } else if (asprintf(&p, "%s/%s", path, ents[i]->d_name) < 0) {
+            p = NULL;
+        }
+        if (!p) {
+            printf("[ERROR] Memory allocation failed\n");
+            exit(1);
+        }
+        (*paths)[(*n)++] = p;
+        if (nents >= 0) free(ents[i]);
+    }
+    free(ents);
+}
+
+int main(int argc, char **argv) {
+    int verbose = 0, first = 1;
+    if (argc > 1 && strcmp(argv[1], "-v") == 0) {
+        verbose = 1;
+        first = 2;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "usage: %s [-v] test.ktest|klee-out-dir...\n", argv[0]);
+        return 2;
+    }
+    char **paths = NULL;
+    size_t npaths = 0, cap = 0;
+    for (int i = first; i < argc; i++)
+        collect(argv[i], &paths, &npaths, &cap);
+
+    FILE *out = verbose ? NULL : fopen("/dev/null", "w");
+    if (!verbose) {
+        // init_system prints its banner to stdout.
+        fflush(stdout);
+        int saved = dup(STDOUT_FILENO);
+        dup2(fileno(out), STDOUT_FILENO);
+        init_system();
+        fflush(stdout);
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+    } else {
+        init_system();
+    }
+
+    size_t counts[REPLAY_KINDS] = { 0 };
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (size_t i = 0; i < npaths; i++) {
+        ktest kt;
+        int rc = ktest_load(paths[i], &kt);
+        if (rc < 0) {
+            printf("%s: invalid (%s)\n", paths[i], strerror(-rc));
+            counts[REPLAY_INVALID]++;
+            free(paths[i]);
+            continue;
+        }
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            int r = replay_one(paths[i], &kt, out);
+            fflush(stdout);
+            _exit(REPLAY_EXIT + r);
+        }
+        int status;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+            ;
+        int kind = REPLAY_CRASH;
+        if (WIFEXITED(status) && WEXITSTATUS(status) >= REPLAY_EXIT &&
+            WEXITSTATUS(status) < REPLAY_EXIT + REPLAY_CRASH)
+            kind = WEXITSTATUS(status) - REPLAY_EXIT;
+        else if (WIFSIGNALED(status))
+            printf("%s: crash (%s)\n", paths[i], strsignal(WTERMSIG(status)));
+        else
+            printf("%s: crash (exit status %d)\n", paths[i], WEXITSTATUS(status));
+        counts[kind]++;
+        ktest_free(&kt);
+        free(paths[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double secs = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    printf("[REPLAY] %zu tests in %.3f s (%.0f/s):", npaths, secs, secs > 0 ? (double)npaths / secs : 0.0);
+    for (int k = 0; k < REPLAY_KINDS; k++)
+        printf(" %zu %s%s", counts[k], replay_names[k], k + 1 < REPLAY_KINDS ? "," : "\n");
+    free(paths);
+    return counts[REPLAY_LEAK] || counts[REPLAY_CRASH] ? 1 : 0;
+}
@@ -2,6 +2,207 @@
 set -euxo pipefail
 
 # Run KLEE on WMI-2 (leak) demo. Build wmi2_demo.bc first with ./build_wmi2.sh
+#
+# MODE=shard (default): the symbolic username space is split into JOBS
+# disjoint shards on its first byte (see driver_wmi2_leak.c), one KLEE per
+# shard. JOBS=1 runs a single KLEE over the whole space, as before.
+#
+# MODE=portfolio: every search strategy in PORTFOLIO explores the whole space
+# in its own KLEE, written "strategy[@max-time[@max-memory-MB]]" to give it
+# its own budget. Up to JOBS run at once. Each strategy's time to bug (or
+# the time it spent without finding one) is appended to HISTORY. Later runs
+# start strategies in order of time spent per bug found for this bitcode, so
+# the historically fastest get the first slots.
+#
+# In both modes the first run to report an error of a kind listed in STOP_ON
+# wins and the rest are cancelled. Test cases and error reports from every
+# run are merged into $OUT/merged, with duplicates dropped.
 
-klee --search=bfs --max-time=60s --exit-on-error-type=Assert wmi2_demo.bc
-echo "[OK] KLEE finished; see klee-out-* for errors/tests"
+: "${MODE:=shard}"
+: "${BC:=wmi2_demo.bc}"
+: "${JOBS:=$(nproc)}"
+: "${MAX_TIME:=60s}"
+: "${MAX_MEMORY:=2000}"
+: "${SEARCH:=bfs}"
+: "${PORTFOLIO:=bfs random-path nurs:covnew dfs}"
+: "${HISTORY:=klee-portfolio.tsv}"
+: "${STOP_ON:=assert}"
+: "${OUT:=klee-par}"
+
+test -f "$BC"
+
+if [ "$MODE" = shard ] && [ "$JOBS" -le 1 ]; then
+  klee --search="$SEARCH" --max-time="$MAX_TIME" --exit-on-error-type=Assert "$BC"
+  echo "[OK] KLEE finished; see klee-out-* for errors/tests"
+  exit 0
+fi
+
+# Prints the PORTFOLIO entries ordered by seconds spent per bug found in
+# HISTORY; strategies that never found one keep their listed order at the end.
+order_portfolio() {
+  local pos=0 spec
+  for spec in $PORTFOLIO; do
+    awk -F'\t' -v bc="$BC" -v s="${spec%%@*}" -v spec="$spec" -v pos="$pos" '
+      $2 == bc && $3 == s { spent += $5; if ($4 == "found") found++ }
+      END { printf "%.3f\t%d\t%s\n", found ? spent / found : 1e18, pos, spec }' "$HISTORY"
+    pos=$((pos + 1))
+  done | sort -t$'\t' -k1,1g -k2,2n | cut -f3
+}
+
+{ set +x; } 2>/dev/null
+names=()
+opts=()
+args=()
+if [ "$MODE" = portfolio ]; then
+  touch "$HISTORY"
+  for spec in $(order_portfolio); do
+    strategy=${spec%%@*}
+    budget=${spec#"$strategy"}
+    budget=${budget#@}
+    time=${budget%%@*}
+    memory=${budget#"$time"}
+    memory=${memory#@}
+    names+=("${strategy//:/-}")
+    opts+=("--search=$strategy --max-time=${time:-$MAX_TIME} --max-memory=${memory:-$MAX_MEMORY}")
+    args+=("")
+  done
+  echo "[INFO] portfolio order: ${names[*]}"
+elif [ "$MODE" = shard ]; then
+  if [ "$JOBS" -gt 255 ]; then JOBS=255; fi
+  for ((i = 0; i < JOBS; i++)); do
+    names+=("shard-$i")
+    opts+=("--search=$SEARCH --max-time=$MAX_TIME --max-memory=$MAX_MEMORY")
+    args+=("$i $JOBS")
+  done
+else
+  echo "[ERROR] MODE must be shard or portfolio" >&2
+  exit 2
+fi
+
+rm -rf "$OUT"
+mkdir -p "$OUT"
+# Job control keeps SIGINT deliverable to the background runs.
+set -m
+
+# Start queued runs while slots are free and nothing has won; interrupt the
+# rest on the first stop error. KLEE treats SIGINT as a request to halt and
+# still writes out its tests; a run still going 30 s later is terminated.
+declare -A pid_of start_of end_of
+now() { date +%s.%N; }
+next=0
+stopped=""
+grace=30
+while :; do
+  live=()
+  for ((i = 0; i < next; i++)); do
+    [ -z "${end_of[$i]:-}" ] || continue
+    if kill -0 "${pid_of[$i]}" 2>/dev/null; then
+      live+=("${pid_of[$i]}")
+    else
+      end_of[$i]=$(now)
+    fi
+  done
+  if [ -z "$stopped" ]; then
+    for kind in $STOP_ON; do
+      hit=$(compgen -G "$OUT/*/*.$kind.err" | head -n 1) || true
+      if [ -n "$hit" ]; then
+        stopped="$hit"
+        echo "[INFO] $hit: cancelling the other runs"
+        if [ "${#live[@]}" -gt 0 ]; then kill -INT "${live[@]}" 2>/dev/null || true; fi
+        break
+      fi
+    done
+  elif [ "${#live[@]}" -gt 0 ]; then
+    grace=$((grace - 1))
+    if [ "$grace" -eq 0 ]; then kill -TERM "${live[@]}" 2>/dev/null || true; fi
+  fi
+  while [ -z "$stopped" ] && [ "$next" -lt "${#names[@]}" ] && [ "${#live[@]}" -lt "$JOBS" ]; do
+    start_of[$next]=$(now)
+    # shellcheck disable=SC2086
+    klee ${opts[$next]} --exit-on-error-type=Assert --output-dir="$OUT/${names[$next]}" \
+         "$BC" ${args[$next]} > "$OUT/${names[$next]}.log" 2>&1 &
+    pid_of[$next]=$!
+    live+=("$!")
+    echo "[INFO] started ${names[$next]}: ${opts[$next]}"
+    next=$((next + 1))
+  done
+  if [ "${#live[@]}" -eq 0 ]; then break; fi
+  sleep 1
+done
+wait || true
+
+# Per-run outcome: time to the first stop error, or the time spent without one.
+runs=()
+for ((i = 0; i < next; i++)); do
+  dir="$OUT/${names[$i]}"
+  result=none
+  end=${end_of[$i]:-$(now)}
+  for kind in $STOP_ON; do
+    err=$(compgen -G "$dir/*.$kind.err" | head -n 1) || true
+    if [ -n "$err" ]; then
+      result=found
+      end=$(date -r "$err" +%s.%N)
+      break
+    fi
+  done
+  if [ "$result" = none ] && [ -n "$stopped" ]; then result=cancelled; fi
+  secs=$(awk -v a="${start_of[$i]}" -v b="$end" 'BEGIN { printf "%.3f", b - a }')
+  runs+=("${names[$i]} $result ${secs}s")
+  if [ "$MODE" = portfolio ]; then
+    strategy=${opts[$i]#--search=}
+    printf '%s\t%s\t%s\t%s\t%s\n' "$(date -u +%FT%TZ)" "$BC" "${strategy%% *}" \
+           "$result" "$secs" >> "$HISTORY"
+  fi
+done
+
+# Merge: a test case is kept once per distinct set of object values (the
+# args differ between shards), and an error report once per kind and
+# source location.
+merged="$OUT/merged"
+mkdir -p "$merged"
+declare -A seen_test seen_err err_runs
+order=()
+total=0
+kept=0
+for t in "$OUT"/*/test*.ktest; do
+  [ -e "$t" ] || continue
+  total=$((total + 1))
+  run=${t#"$OUT"/}
+  run=${run%%/*}
+  base=${t%.ktest}
+  sum=$(ktest-tool "$t" | sed -n '/^num objects/,$p' | sha256sum | cut -d' ' -f1)
+  id="${seen_test[$sum]:-}"
+  if [ -z "$id" ]; then
+    kept=$((kept + 1))
+    id=$(printf 'test%06d' "$kept")
+    seen_test[$sum]="$id"
+    cp "$t" "$merged/$id.ktest"
+  fi
+  for err in "$base".*.err; do
+    [ -e "$err" ] || continue
+    key="$(sed -n '1,3p' "$err" | tr '\n' ' ')"
+    if [ -z "${seen_err[$key]:-}" ]; then
+      seen_err[$key]="$id"
+      order+=("$key")
+      cp "$err" "$merged/$id.${err#"$base".}"
+    fi
+    case " ${err_runs[$key]:-} " in
+      *" $run "*) ;;
+      *) err_runs[$key]="${err_runs[$key]:-} $run" ;;
+    esac
+  done
+done
+
+{
+  echo "mode: $MODE, ${#runs[@]} runs"
+  for r in "${runs[@]}"; do echo "  $r"; done
+  echo "stopped by: ${stopped:-none}"
+  echo "tests: $kept unique of $total"
+  echo "errors: ${#order[@]} unique"
+  for key in "${order[@]}"; do
+    echo "  $key-> ${seen_err[$key]} (runs:${err_runs[$key]})"
+  done
+} | tee "$merged/summary.txt"
+set -x
+
+echo "[OK] KLEE finished; see $merged for merged errors/tests"
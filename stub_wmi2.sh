@@ -17,16 +17,46 @@ cat > "$HERE/stubs_wmi2.c" <<'EOF'
 #endif
 
 int printf(const char *fmt, ...) { (void)fmt; return 0; }
+int fprintf(void *stream, const char *fmt, ...) { (void)stream; (void)fmt; return 0; }
 int puts(const char *s) { (void)s; return 0; }
+int fputs(const char *s, void *stream) { (void)s; (void)stream; return 0; }
 int putchar(int c) { (void)c; return c; }
+int fputc(int c, void *stream) { (void)stream; return c; }
 
 void *stdin;
+void *stdout;
 
 int getchar(void) { return -1; }
 
 /* WMI-2: set_start_location() needs real input so it allocates and can reuse
    freed avatar memory. Return a fixed string so set_start_location gets "127"
-   and performs malloc(start_loc) + malloc(location_name). */
+   and performs malloc(start_loc); the port's coordinates come from the port
+   catalog in globals.c.
+
+   With -DWMI2_SYMBOLIC_STDIN (STDIN=symbolic in build_wmi2.sh) every call
+   returns a fresh symbolic line instead: WMI2_STDIN_LINE symbolic bytes,
+   none of them '\n', then a concrete "\n\0". A symbolic NUL ends the line
+   early, so one line covers every length up to the bound, and the
+   fixed-trip-count string functions below read it without forking. */
+#if defined(WMI2_SYMBOLIC_STDIN) && defined(__KLEE__)
+#ifndef WMI2_STDIN_LINE
+#define WMI2_STDIN_LINE 4
+#endif
+char *fgets(char *s, int size, void *stream) {
+  (void)stream;
+  if (!s || size < 3) return NULL;
+  char line[WMI2_STDIN_LINE];
+  klee_make_symbolic(line, sizeof(line), "stdin");
+  int n = size - 2 < WMI2_STDIN_LINE ? size - 2 : WMI2_STDIN_LINE;
+  for (int i = 0; i < n; i++) {
+    klee_assume(line[i] != '\n');
+    s[i] = line[i];
+  }
+  s[n] = '\n';
+  s[n + 1] = '\0';
+  return s;
+}
+#else
 char *fgets(char *s, int size, void *stream) {
   (void)stream;
   if (!s || size < 5) return NULL;
@@ -36,9 +66,118 @@ char *fgets(char *s, int size, void *stream) {
   s[i] = '\0';
   return s;
 }
+#endif
 
 int __isoc99_scanf(const char *fmt, ...) { (void)fmt; return 0; }
 
+/* String functions. KLEE forks a state at every branch on a symbolic byte,
+   so a byte loop with a data-dependent exit turns one strcmp of the 16-byte
+   symbolic username into up to 16 states. These versions run a fixed number
+   of iterations and fold every byte into the result with masks, so a
+   comparison becomes a single expression and the caller's one branch on it
+   forks once. A scan ends only at a byte that is concretely NUL (the
+   driver terminates its buffers, and the literals are concrete); bytes past
+   a symbolic terminator are read but masked out. Build with
+   -DWMI2_STUBS_BYTEWISE for the plain byte loops (see bench_stubs_wmi2.sh).
+   strtol gets the same treatment. */
+#ifdef __KLEE__
+  #define CONCRETE_NUL(c) (!klee_is_symbolic((uintptr_t)(unsigned char)(c)) && (c) == 0)
+#else
+  #define CONCRETE_NUL(c) ((c) == 0)
+#endif
+
+#ifndef WMI2_STUBS_BYTEWISE
+size_t strlen(const char *s) {
+  if (!s) return 0;
+  size_t n = 0, live = 1;
+  for (size_t i = 0; ; i++) {
+    unsigned char c = (unsigned char)s[i];
+    live &= (c != 0);
+    n += live;
+    if (CONCRETE_NUL(c)) break;
+  }
+  return n;
+}
+
+size_t strnlen(const char *s, size_t maxlen) {
+  if (!s) return 0;
+  size_t n = 0, live = 1;
+  for (size_t i = 0; i < maxlen; i++) {
+    unsigned char c = (unsigned char)s[i];
+    live &= (c != 0);
+    n += live;
+    if (CONCRETE_NUL(c)) break;
+  }
+  return n;
+}
+
+size_t strcspn(const char *s, const char *reject) {
+  if (!s || !reject) return 0;
+  size_t n = 0, live = 1;
+  for (size_t i = 0; ; i++) {
+    unsigned char c = (unsigned char)s[i];
+    size_t hit = (c == 0), rlive = 1;
+    for (size_t j = 0; !CONCRETE_NUL(reject[j]); j++) {
+      unsigned char r = (unsigned char)reject[j];
+      rlive &= (r != 0);
+      hit |= rlive & (c == r);
+    }
+    live &= !hit;
+    n += live;
+    if (CONCRETE_NUL(c)) break;
+  }
+  return n;
+}
+
+int strcmp(const char *a, const char *b) {
+  if (a == b) return 0;
+  if (!a) return -1;
+  if (!b) return 1;
+  int r = 0;
+  unsigned live = 1;            /* every byte so far equal and non-NUL */
+  for (size_t i = 0; ; i++) {
+    unsigned char ca = (unsigned char)a[i], cb = (unsigned char)b[i];
+    r |= ((int)ca - (int)cb) & -(int)live;
+    live &= (ca == cb) & (ca != 0);
+    if (CONCRETE_NUL(ca) || CONCRETE_NUL(cb)) break;
+  }
+  return r;
+}
+
+char *strncpy(char *dst, const char *src, size_t n) {
+  if (!dst || !src) return dst;
+  unsigned char live = 0xff;    /* 0 once src has ended */
+  int ended = 0;                /* src ended at a concrete NUL: stop reading */
+  for (size_t i = 0; i < n; i++) {
+    unsigned char c = ended ? 0 : (unsigned char)src[i];
+    c &= live;
+    dst[i] = (char)c;
+    live &= (unsigned char)-(c != 0);
+    ended |= CONCRETE_NUL(c);
+  }
+  return dst;
+}
+
+/* Decimal digits only, like the byte loop: no sign, no whitespace, no
+   overflow check. The value and the digit count are folded over the whole
+   string, so a symbolic number is one expression and *endptr points just
+   past the last digit. */
+long strtol(const char *nptr, char **endptr, int base) {
+  (void)base;
+  if (!nptr) { if (endptr) *endptr = (char*)nptr; return 0; }
+  long v = 0;
+  size_t n = 0, live = 1;       /* every byte so far a digit */
+  for (size_t i = 0; ; i++) {
+    unsigned char c = (unsigned char)nptr[i];
+    live &= ((unsigned)(c - '0') < 10u);
+    v = v * (long)(1 + 9 * live) + (long)(c - '0') * (long)live;
+    n += live;
+    if (CONCRETE_NUL(c)) break;
+  }
+  if (endptr) *endptr = (char*)nptr + n;
+  return v;
+}
+#else
 size_t strlen(const char *s) {
   if (!s) return 0;
   size_t n = 0;
@@ -79,15 +218,6 @@ char *strncpy(char *dst, const char *src, size_t n) {
   return dst;
 }
 
-char *strdup(const char *s) {
-  if (!s) return NULL;
-  size_t n = strlen(s) + 1;
-  char *p = (char *)malloc(n);
-  if (!p) return NULL;
-  for (size_t i = 0; i < n; i++) p[i] = s[i];
-  return p;
-}
-
 long strtol(const char *nptr, char **endptr, int base) {
   (void)base;
   if (!nptr) { if (endptr) *endptr = (char*)nptr; return 0; }
@@ -97,6 +227,16 @@ long strtol(const char *nptr, char **endptr, int base) {
   if (endptr) *endptr = (char*)p;
   return v;
 }
+#endif
+
+char *strdup(const char *s) {
+  if (!s) return NULL;
+  size_t n = strlen(s) + 1;
+  char *p = (char *)malloc(n);
+  if (!p) return NULL;
+  for (size_t i = 0; i < n; i++) p[i] = s[i];
+  return p;
+}
 
 void *memcpy(void *dst, const void *src, size_t n) {
   unsigned char *d = (unsigned char *)dst;
@@ -112,9 +252,346 @@ void *memset(void *s, int c, size_t n) {
   return s;
 }
 
-double sin(double x) { (void)x; return 0.0; }
-double cos(double x) { (void)x; return 0.0; }
-long long llround(double x) { (void)x; return 0; }
+/* Allocator model (HEAP=tcache in build_wmi2.sh). KLEE's allocator hands
+   out fresh addresses, so a freed chunk is rarely what a later malloc
+   returns, as it would be under glibc. Reaching a path that depends on
+   reuse then takes a long blind search. This model lays chunks out the way
+   glibc does, in a static arena: an 8-byte size field, 16-byte granularity
+   and a 32-byte minimum. Freed chunks go on glibc's tcache: one LIFO list
+   per chunk size up to 1032 bytes, at most 7 entries each, with the
+   safe-linked next pointer and the key in the chunk's first 16 bytes.
+   Frees past the cap go to a second LIFO list per size that stands in for
+   the fastbins. calloc skips the tcache, as glibc's does, and takes from
+   the fastbin list or the top. Reuse is O(1) and the same on every path.
+   Larger chunks are carved from the top and never reused. KLEE cannot see
+   a use after free inside the arena, but the shadow heap still records
+   which chunks are freed. */
+#ifdef WMI2_TCACHE
+#define TCACHE_ARENA    (4u << 20)
+#define TCACHE_BINS     64
+#define TCACHE_COUNT    7
+#define TCACHE_MINSIZE  32
+
+static _Alignas(16) unsigned char tcache_arena[TCACHE_ARENA];
+static size_t tcache_top;
+static struct {
+  void *bin[TCACHE_BINS];
+  unsigned count[TCACHE_BINS];
+  void *fast[TCACHE_BINS];
+} tcache;
+
+static void tcache_fail(const char *msg, const char *suffix) {
+#ifdef __KLEE__
+  klee_report_error(__FILE__, __LINE__, msg, suffix);
+#else
+  (void)msg; (void)suffix;
+  abort();
+#endif
+}
+
+/* glibc's safe-linking: a next pointer is stored xor'd with its own
+   address shifted right by 12. */
+static void *tcache_link(void **pos, void *next) {
+  return (void *)(((uintptr_t)pos >> 12) ^ (uintptr_t)next);
+}
+
+static size_t tcache_chunk_size(size_t n) {
+  size_t c = (n + 8 + 15) & ~(size_t)15;
+  return c < TCACHE_MINSIZE ? TCACHE_MINSIZE : c;
+}
+
+static size_t tcache_usable(void *p) {
+  return (((size_t *)p)[-1] & ~(size_t)7) - 8;
+}
+
+static int tcache_owns(const void *p) {
+  uintptr_t a = (uintptr_t)p, base = (uintptr_t)tcache_arena;
+  return a >= base && a < base + TCACHE_ARENA;
+}
+
+static void *tcache_alloc(size_t n, int use_tcache) {
+  if (n > TCACHE_ARENA) return NULL;
+  size_t csize = tcache_chunk_size(n);
+  size_t bin = csize / 16 - 2;
+  void **list = NULL;
+  if (use_tcache && bin < TCACHE_BINS && tcache.bin[bin]) {
+    list = &tcache.bin[bin];
+    tcache.count[bin]--;
+  } else if (bin < TCACHE_BINS && tcache.fast[bin]) {
+    list = &tcache.fast[bin];
+  }
+  if (list) {
+    void **e = (void **)*list;
+    *list = tcache_link(e, e[0]);
+    e[1] = NULL;
+    return e;
+  }
+  /* The last chunk's tail overlaps the next chunk's prev_size: keep 16
+     bytes of slack past the top. */
+  if (csize + 16 > TCACHE_ARENA - tcache_top) {
+    tcache_fail("allocator model: arena exhausted", "model.err");
+    return NULL;
+  }
+  unsigned char *chunk = tcache_arena + tcache_top;
+  tcache_top += csize;
+  ((size_t *)chunk)[1] = csize | 1;     /* PREV_INUSE */
+  return chunk + 16;
+}
+
+static void *tcache_malloc(size_t n) {
+  return tcache_alloc(n, 1);
+}
+
+static void tcache_free(void *p) {
+  if (!p) return;
+  if (!tcache_owns(p)) { free(p); return; }
+  void **e = (void **)p;
+  size_t bin = (tcache_usable(p) + 8) / 16 - 2;
+  if (bin >= TCACHE_BINS) return;
+  if (e[1] == (void *)&tcache) {
+    for (void **c = (void **)tcache.bin[bin]; c; c = (void **)tcache_link(c, c[0]))
+      if (c == e) tcache_fail("free(): double free detected in tcache 2", "free.err");
+  }
+  if (tcache.count[bin] < TCACHE_COUNT) {
+    e[0] = tcache_link(e, tcache.bin[bin]);
+    e[1] = (void *)&tcache;
+    tcache.bin[bin] = e;
+    tcache.count[bin]++;
+  } else {
+    if (tcache.fast[bin] == e)
+      tcache_fail("double free or corruption (fasttop)", "free.err");
+    e[0] = tcache_link(e, tcache.fast[bin]);
+    tcache.fast[bin] = e;
+  }
+}
+
+static void *tcache_calloc(size_t n, size_t size) {
+  if (size && n > TCACHE_ARENA / size) return NULL;
+  unsigned char *p = (unsigned char *)tcache_alloc(n * size, 0);
+  if (p) for (size_t i = 0; i < n * size; i++) p[i] = 0;
+  return p;
+}
+
+static void *tcache_realloc(void *old, size_t n) {
+  if (!old) return tcache_malloc(n);
+  if (!tcache_owns(old)) return realloc(old, n);
+  size_t have = tcache_usable(old);
+  if (n <= have) return old;
+  unsigned char *p = (unsigned char *)tcache_malloc(n);
+  if (!p) return NULL;
+  for (size_t i = 0; i < have; i++) p[i] = ((unsigned char *)old)[i];
+  tcache_free(old);
+  return p;
+}
+
+#define HEAP_MALLOC(n)        tcache_malloc(n)
+#define HEAP_CALLOC(n, size)  tcache_calloc((n), (size))
+#define HEAP_REALLOC(p, n)    tcache_realloc((p), (n))
+#define HEAP_FREE(p)          tcache_free(p)
+#else
+#define HEAP_MALLOC(n)        malloc(n)
+#define HEAP_CALLOC(n, size)  calloc((n), (size))
+#define HEAP_REALLOC(p, n)    realloc((p), (n))
+#define HEAP_FREE(p)          free(p)
+#endif
+
+/* Shadow heap. metalogin.c's KLEE build allocates through shadow_malloc and
+   friends (see metalogin.c), which call the allocator and record each
+   chunk's bounds, allocation site and live/freed state. The driver's leak
+   oracle uses shadow_lookup to ask whether a value is the address of a
+   known chunk, and which one. Records live in a static arena so the
+   bookkeeping never changes what the heap hands out. Chunks in the tree
+   never overlap: a freed chunk is dropped once its memory is handed out
+   again. A balanced search tree ordered by start address is therefore an
+   interval tree, and the only candidate for an address is the last chunk
+   starting at or below it. */
+#define SHADOW_MAX_CHUNKS 4096
+
+typedef struct shadow_node {
+  uintptr_t addr;
+  size_t size;
+  const char *func;
+  int line;
+  int live;
+  int height;
+  struct shadow_node *left, *right;
+} shadow_node;
+
+static shadow_node shadow_nodes[SHADOW_MAX_CHUNKS];
+static shadow_node *shadow_spare;       /* released nodes, linked by right */
+static size_t shadow_used;
+static shadow_node *shadow_root;
+
+static shadow_node *shadow_node_new(void) {
+  shadow_node *n = shadow_spare;
+  if (n) {
+    shadow_spare = n->right;
+  } else if (shadow_used < SHADOW_MAX_CHUNKS) {
+    n = &shadow_nodes[shadow_used++];
+  } else {
+#ifdef __KLEE__
+    klee_report_error(__FILE__, __LINE__, "shadow heap full", "shadow.err");
+#else
+    abort();
+#endif
+  }
+  return n;
+}
+
+static int shadow_height(const shadow_node *n) { return n ? n->height : 0; }
+
+static shadow_node *shadow_fix(shadow_node *n) {
+  int l = shadow_height(n->left), r = shadow_height(n->right);
+  n->height = 1 + (l > r ? l : r);
+  return n;
+}
+
+static shadow_node *shadow_rotate_right(shadow_node *n) {
+  shadow_node *l = n->left;
+  n->left = l->right;
+  l->right = shadow_fix(n);
+  return shadow_fix(l);
+}
+
+static shadow_node *shadow_rotate_left(shadow_node *n) {
+  shadow_node *r = n->right;
+  n->right = r->left;
+  r->left = shadow_fix(n);
+  return shadow_fix(r);
+}
+
+static shadow_node *shadow_balance(shadow_node *n) {
+  shadow_fix(n);
+  int b = shadow_height(n->left) - shadow_height(n->right);
+  if (b > 1) {
+    if (shadow_height(n->left->left) < shadow_height(n->left->right))
+      n->left = shadow_rotate_left(n->left);
+    return shadow_rotate_right(n);
+  }
+  if (b < -1) {
+    if (shadow_height(n->right->right) < shadow_height(n->right->left))
+      n->right = shadow_rotate_right(n->right);
+    return shadow_rotate_left(n);
+  }
+  return n;
+}
+
+static shadow_node *shadow_insert(shadow_node *t, shadow_node *n) {
+  if (!t) return shadow_fix(n);
+  if (n->addr < t->addr) t->left = shadow_insert(t->left, n);
+  else t->right = shadow_insert(t->right, n);
+  return shadow_balance(t);
+}
+
+static shadow_node *shadow_unlink_min(shadow_node *t, shadow_node **min) {
+  if (!t->left) {
+    *min = t;
+    return t->right;
+  }
+  t->left = shadow_unlink_min(t->left, min);
+  return shadow_balance(t);
+}
+
+/* Unlinks the node starting at addr and puts it on the spare list. */
+static shadow_node *shadow_remove(shadow_node *t, uintptr_t addr) {
+  if (!t) return NULL;
+  if (addr < t->addr) {
+    t->left = shadow_remove(t->left, addr);
+  } else if (addr > t->addr) {
+    t->right = shadow_remove(t->right, addr);
+  } else {
+    shadow_node *l = t->left, *r = t->right, *min;
+    t->right = shadow_spare;
+    shadow_spare = t;
+    if (!r) return l;
+    r = shadow_unlink_min(r, &min);
+    min->left = l;
+    min->right = r;
+    return shadow_balance(min);
+  }
+  return shadow_balance(t);
+}
+
+/* Last chunk starting at or below addr. */
+static shadow_node *shadow_floor(uintptr_t addr) {
+  shadow_node *n = shadow_root, *best = NULL;
+  while (n) {
+    if (n->addr <= addr) { best = n; n = n->right; }
+    else n = n->left;
+  }
+  return best;
+}
+
+static size_t shadow_span(size_t size) { return size ? size : 1; }
+
+static void shadow_track(void *p, size_t size, const char *func, int line) {
+  if (!p) return;
+  uintptr_t a = (uintptr_t)p;
+  shadow_node *old;
+  while ((old = shadow_floor(a + shadow_span(size) - 1)) &&
+         old->addr + shadow_span(old->size) > a)
+    shadow_root = shadow_remove(shadow_root, old->addr);
+  shadow_node *n = shadow_node_new();
+  n->addr = a;
+  n->size = size;
+  n->func = func;
+  n->line = line;
+  n->live = 1;
+  n->left = n->right = NULL;
+  shadow_root = shadow_insert(shadow_root, n);
+}
+
+static void shadow_untrack(void *p) {
+  shadow_node *n = shadow_floor((uintptr_t)p);
+  if (n && n->addr == (uintptr_t)p) n->live = 0;
+}
+
+void *shadow_malloc(size_t n, const char *func, int line) {
+  void *p = HEAP_MALLOC(n);
+  shadow_track(p, n, func, line);
+  return p;
+}
+
+void *shadow_calloc(size_t n, size_t size, const char *func, int line) {
+  void *p = HEAP_CALLOC(n, size);
+  shadow_track(p, n * size, func, line);
+  return p;
+}
+
+void *shadow_realloc(void *old, size_t n, const char *func, int line) {
+  void *p = HEAP_REALLOC(old, n);
+  if (!p && n) return NULL;
+  if (old) shadow_untrack(old);
+  shadow_track(p, n, func, line);
+  return p;
+}
+
+char *shadow_strdup(const char *s, const char *func, int line) {
+  if (!s) return NULL;
+  size_t n = strlen(s) + 1;
+  char *p = (char *)shadow_malloc(n, func, line);
+  if (!p) return NULL;
+  for (size_t i = 0; i < n; i++) p[i] = s[i];
+  return p;
+}
+
+/* A free of an untracked or already freed pointer still reaches free(), so
+   KLEE reports the invalid or double free itself. */
+void shadow_free(void *p) {
+  if (p) shadow_untrack(p);
+  HEAP_FREE(p);
+}
+
+int shadow_lookup(uintptr_t addr, uintptr_t *base, size_t *size,
+                  const char **func, int *line) {
+  shadow_node *n = shadow_floor(addr);
+  if (!n || addr - n->addr >= shadow_span(n->size)) return -1;
+  if (base) *base = n->addr;
+  if (size) *size = n->size;
+  if (func) *func = n->func;
+  if (line) *line = n->line;
+  return n->live;
+}
 
 void print_card(void) {}
 
@@ -0,0 +1,95 @@
+// test_blacksun.c - MetaLogin Avatar Manager
+// Stress test for Black Sun directory hot reload: reader threads verify
+// logins without pause while a writer reloads the directory back to back.
+// Each reload unmaps the file behind the directory it replaces and frees its
+// tables, so a reader still using a retired directory faults or gets a wrong
+// answer; run_tests.sh builds this test with AddressSanitizer, which also
+// reports every read of a freed table.
+//
+//   ./run_tests.sh                     # builds and runs every test
+//   ./test_blacksun [reloads] [readers]
+#include "metalogin.h"
+
+#include <pthread.h>
+
+#define TEST_RELOADS  2000
+#define TEST_READERS  4
+
+static atomic_int test_done;
+static atomic_ulong test_checks;
+static atomic_int test_failed;
+
+// Both files hold the built-in members plus filler, in a different order
+// so every reload builds a different table.
+static int write_directory(const char *path, int reversed) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    for (int i = 0; i < 64; i++) {
+        int k = reversed ? 63 - i : i;
+        if (k < NUM_BLACK_SUN_MEMBERS)
+            fprintf(f, "%s %s\n", black_sun_member_usernames[k], black_sun_member_access_codes[k]);
+        else
+            fprintf(f, "filler%02d code%02d\n", k, k);
+    }
+    return fclose(f);
+}
+
+static void *reader(void *arg) {
+    unsigned i = (unsigned)(uintptr_t)arg;
+    while (!atomic_load(&test_done)) {
+        int k = i++ % NUM_BLACK_SUN_MEMBERS;
+        if (blacksun_verify(black_sun_member_usernames[k], black_sun_member_access_codes[k]) != 1 ||
+            blacksun_verify(black_sun_member_usernames[k], "wrong") != -1 ||
+            blacksun_verify("nobody", "wrong") != 0) {
+            atomic_store(&test_failed, 1);
+            break;
+        }
+        atomic_fetch_add_explicit(&test_checks, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    long reloads = argc > 1 ? atol(argv[1]) : TEST_RELOADS;
+    int nreaders = argc > 2 ? atoi(argv[2]) : TEST_READERS;
+    if (reloads < 1 || nreaders < 1 || nreaders > 256) {
+        fprintf(stderr, "usage: %s [reloads] [readers]\n", argv[0]);
+        return 2;
+    }
+
+    char paths[2][64];
+    for (int i = 0; i < 2; i++) {
+        snprintf(paths[i], sizeof(paths[i]), "/tmp/test_blacksun.%d.%d", (int)getpid(), i);
+        if (write_directory(paths[i], i) < 0) {
+            perror(paths[i]);
+            return 1;
+        }
+    }
+
+    pthread_t threads[256];
+    for (int i = 0; i < nreaders; i++)
+        pthread_create(&threads[i], NULL, reader, (void *)(uintptr_t)i);
+
+    int rc = 0;
+    for (long r = 0; r < reloads && !atomic_load(&test_failed); r++) {
+        if (blacksun_load(paths[r & 1]) != 64) {
+            fprintf(stderr, "[ERROR] reload %ld of %s failed\n", r, paths[r & 1]);
+            rc = 1;
+            break;
+        }
+    }
+    atomic_store(&test_done, 1);
+    for (int i = 0; i < nreaders; i++)
+        pthread_join(threads[i], NULL);
+    blacksun_reset();
+    unlink(paths[0]);
+    unlink(paths[1]);
+
+    if (atomic_load(&test_failed)) {
+        fprintf(stderr, "[ERROR] a reader saw a retired directory\n");
+        rc = 1;
+    }
+    printf("[TEST] blacksun: %ld reloads, %d readers, %lu checks: %s\n",
+           reloads, nreaders, atomic_load(&test_checks), rc ? "FAIL" : "ok");
+    return rc;
+}
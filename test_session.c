@@ -0,0 +1,70 @@
+// test_session.c - MetaLogin Avatar Manager
+// Session lifecycle under METALOGIN_SYSTEM_ALLOC, where avatar handles are
+// raw heap addresses with no generation check. clear_avatar leaves a stale
+// current_avatar behind (WMI-2); nothing after it may free that avatar
+// again. run_tests.sh builds this with AddressSanitizer, which reports any
+// double free.
+#include "metalogin.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+static int failures;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "[ERROR] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+int main(void) {
+    // Sessions print to stdout; only the result line is kept.
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    if (saved < 0 || null < 0) {
+        perror("/dev/null");
+        return 1;
+    }
+    dup2(null, STDOUT_FILENO);
+    close(null);
+
+    const char *member = black_sun_member_usernames[0];
+    const char *code = black_sun_member_access_codes[0];
+
+    // Logout, then close.
+    session_h sess = session_open();
+    set_avatar(sess, "guest", "x");
+    clear_avatar(sess);
+    CHECK(session_get(sess)->avatar_released);
+    session_close(sess);
+
+    // Logout twice, then log in again over the stale handle.
+    sess = session_open();
+    set_avatar(sess, "guest", "x");
+    CHECK(inventory_add(sess, "katana", 42) == 0);
+    clear_avatar(sess);
+    clear_avatar(sess);
+    CHECK(inventory_add(sess, "katana", 43) == 0);   // the guest inventory
+    inventory_clear_all(sess);
+    view_inventory(sess);
+    set_avatar(sess, "visitor", "y");
+    CHECK(!session_get(sess)->avatar_released);
+    CHECK(inventory_add(sess, "sword", 7) == 0);
+    session_close(sess);
+
+    // A denied login while logged in frees the old avatar and keeps its handle.
+    sess = session_open();
+    set_avatar(sess, (char *)member, (char *)code);
+    set_avatar(sess, (char *)member, "wrong");
+    CHECK(session_get(sess)->avatar_released);
+    clear_avatar(sess);
+    session_close(sess);
+
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    printf("[TEST] session: %s\n", failures ? "FAIL" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+// test_snapshot.c - MetaLogin Avatar Manager
+// Snapshot round trips: a session keeps a guest inventory and, while logged
+// in, an avatar inventory, and both must come back from snapshot_load. The
+// inventories are compared through inventory_export, and the guest one is
+// checked again after the restored avatar logs out.
+#include "metalogin.h"
+
+#include <fcntl.h>
+
+#define TEST_GUEST_ITEMS 20000
+
+static int failures;
+static FILE *devnull;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "[ERROR] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static session_h open_quiet(void) {
+    session_h sess = session_open();
+    session_get(sess)->out = devnull;
+    return sess;
+}
+
+// Items in the session's current inventory.
+static long count_items(session_h sess) {
+    int fd = open("/dev/null", O_WRONLY);
+    long n = inventory_export(sess, fd, ML_ITEMS_TEXT);
+    close(fd);
+    return n;
+}
+
+static session_h round_trip(const char *path, session_h sess) {
+    CHECK(snapshot_save(path, &sess, 1) == 0);
+    session_close(sess);
+    session_h back = ML_NULL_HANDLE;
+    CHECK(snapshot_load(path, &back, 1) == 1);
+    if (back) session_get(back)->out = devnull;
+    return back;
+}
+
+int main(void) {
+    devnull = fopen("/dev/null", "w");
+    if (!devnull) {
+        perror("/dev/null");
+        return 1;
+    }
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_snapshot.%d", (int)getpid());
+
+    // Guest items, then a login whose avatar adds its own.
+    session_h sess = open_quiet();
+    for (long i = 0; i < TEST_GUEST_ITEMS; i++)
+        inventory_add(sess, "guest_item", i);
+    set_avatar(sess, "guest", "x");
+    inventory_add(sess, "avatar_item", -1);
+    inventory_add(sess, "avatar_item", -2);
+    CHECK(count_items(sess) == TEST_GUEST_ITEMS + 2);
+    sess = round_trip(path, sess);
+    if (sess) {
+        CHECK(session_get(sess)->is_active);
+        CHECK(count_items(sess) == TEST_GUEST_ITEMS + 2);
+        CHECK(inventory_remove_by_obj(sess, -1) == 1);
+        clear_avatar(sess);
+        CHECK(count_items(sess) == TEST_GUEST_ITEMS);
+        CHECK(inventory_remove_by_obj(sess, -2) == 0);
+        CHECK(inventory_remove_by_obj(sess, TEST_GUEST_ITEMS - 1) == 1);
+        CHECK(count_items(sess) == TEST_GUEST_ITEMS - 1);
+        session_close(sess);
+    }
+
+    // An avatar still sharing the guest inventory is stored once and comes
+    // back shared: a change on either side leaves the other intact.
+    sess = open_quiet();
+    inventory_add(sess, "shared", 1);
+    set_avatar(sess, "guest", "x");
+    sess = round_trip(path, sess);
+    if (sess) {
+        CHECK(count_items(sess) == 1);
+        CHECK(inventory_add(sess, "mine", 2) == 0);
+        CHECK(count_items(sess) == 2);
+        clear_avatar(sess);
+        CHECK(count_items(sess) == 1);
+        session_close(sess);
+    }
+
+    // After logout the session is a guest again and saves as one.
+    sess = open_quiet();
+    inventory_add(sess, "kept", 5);
+    set_avatar(sess, "guest", "x");
+    inventory_add(sess, "dropped", 6);
+    clear_avatar(sess);
+    sess = round_trip(path, sess);
+    if (sess) {
+        CHECK(!session_get(sess)->is_active);
+        CHECK(count_items(sess) == 1);
+        CHECK(inventory_remove_by_obj(sess, 5) == 1);
+        session_close(sess);
+    }
+
+    unlink(path);
+    fclose(devnull);
+    printf("[TEST] snapshot: %s\n", failures ? "FAIL" : "ok");
+    return failures ? 1 : 0;
+}